@@ -0,0 +1,176 @@
+#ifndef FIELDS_HPP
+#define FIELDS_HPP
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <string_view>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FIELDS_HAS_SSE2 1
+#endif
+
+namespace fields
+{
+    // fields of a single record - views into the original line (no copies, no allocations)
+    template <size_t MaxFields = 32>
+    class Fields
+    {
+        static_assert(MaxFields > 0);
+
+        std::array<std::string_view, MaxFields> fields_{};
+        size_t size_ = 0;
+
+    public:
+        using value_type = std::string_view;
+        using const_iterator = const std::string_view*;
+
+        constexpr Fields() = default;
+
+        constexpr const_iterator begin() const noexcept
+        {
+            return fields_.data();
+        }
+
+        constexpr const_iterator end() const noexcept
+        {
+            return fields_.data() + size_;
+        }
+
+        constexpr size_t size() const noexcept
+        {
+            return size_;
+        }
+
+        constexpr bool empty() const noexcept
+        {
+            return size_ == 0;
+        }
+
+        constexpr std::string_view operator[](size_t index) const noexcept
+        {
+            assert(index < size_);
+            return fields_[index];
+        }
+
+        constexpr bool full() const noexcept
+        {
+            return size_ == MaxFields;
+        }
+
+        constexpr void push_back(std::string_view field) noexcept
+        {
+            assert(size_ < MaxFields);
+            fields_[size_++] = field;
+        }
+
+        constexpr void clear() noexcept
+        {
+            size_ = 0;
+        }
+    };
+
+    static_assert(std::ranges::random_access_range<Fields<>>);
+    static_assert(std::ranges::contiguous_range<Fields<>>);
+
+    namespace details
+    {
+        constexpr uint32_t scan_block_size = 16;
+
+#ifdef FIELDS_HAS_SSE2
+        // bit i of the result is set if block[i] is equal to value_1 or value_2
+        inline uint32_t match_mask(const char* block, __m128i value_1, __m128i value_2) noexcept
+        {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+            const __m128i matches = _mm_or_si128(_mm_cmpeq_epi8(chunk, value_1), _mm_cmpeq_epi8(chunk, value_2));
+
+            return static_cast<uint32_t>(_mm_movemask_epi8(matches));
+        }
+#endif
+
+        // calls on_match(pos) for every position where text[pos] is equal to value_1 or value_2
+        template <typename TCallback>
+        void find_each(std::string_view text, char value_1, char value_2, TCallback&& on_match)
+        {
+            const char* data = text.data();
+            size_t pos = 0;
+
+#ifdef FIELDS_HAS_SSE2
+            const __m128i pattern_1 = _mm_set1_epi8(value_1);
+            const __m128i pattern_2 = _mm_set1_epi8(value_2);
+
+            for (; pos + scan_block_size <= text.size(); pos += scan_block_size)
+            {
+                for (uint32_t mask = match_mask(data + pos, pattern_1, pattern_2); mask != 0; mask &= mask - 1)
+                {
+                    on_match(pos + std::countr_zero(mask));
+                }
+            }
+#endif
+
+            for (; pos < text.size(); ++pos)
+            {
+                if (data[pos] == value_1 || data[pos] == value_2)
+                    on_match(pos);
+            }
+        }
+    } // namespace details
+
+    // splits line into fields; if there are more than MaxFields fields the last one holds the rest of the line
+    template <size_t MaxFields = 32>
+    Fields<MaxFields> split_fields(std::string_view line, char separator = '/')
+    {
+        Fields<MaxFields> result;
+        size_t field_start = 0;
+
+        details::find_each(line, separator, separator, [&](size_t pos) {
+            if (result.size() + 1 < MaxFields)
+            {
+                result.push_back(line.substr(field_start, pos - field_start));
+                field_start = pos + 1;
+            }
+        });
+
+        result.push_back(line.substr(field_start));
+
+        return result;
+    }
+
+    // calls on_record(fields) for every line of the buffer - lines and fields are found in a single pass
+    template <size_t MaxFields = 32, typename TCallback>
+    void for_each_record(std::string_view buffer, char separator, TCallback&& on_record)
+    {
+        Fields<MaxFields> record;
+        size_t field_start = 0;
+
+        details::find_each(buffer, separator, '\n', [&](size_t pos) {
+            if (buffer[pos] == '\n')
+            {
+                record.push_back(buffer.substr(field_start, pos - field_start));
+                on_record(std::as_const(record));
+                record.clear();
+                field_start = pos + 1;
+            }
+            else if (record.size() + 1 < MaxFields)
+            {
+                record.push_back(buffer.substr(field_start, pos - field_start));
+                field_start = pos + 1;
+            }
+        });
+
+        // last line without '\n' - a record ending with a separator still has an (empty) last field
+        if (!record.empty() || field_start < buffer.size())
+        {
+            record.push_back(buffer.substr(field_start));
+            on_record(std::as_const(record));
+        }
+    }
+} // namespace fields
+
+#endif
@@ -8,6 +8,8 @@
 #include <source_location>
 #include <ranges>
 #include <helpers.hpp>
+#include "fields.hpp"
+#include "records.hpp"
 
 template <typename T1, typename T2>
 std::ostream& operator<<(std::ostream& out, const std::pair<T1, T2>& p)
@@ -24,10 +26,10 @@ std::pair<std::string_view, std::string_view> split(std::string_view line, std::
 {
     std::pair<std::string_view, std::string_view> result;
 
-    if (std::string::size_type pos = line.find(separator.data()); pos != std::string::npos)
+    if (std::string::size_type pos = line.find(separator); pos != std::string::npos)
     {
-        result.first = std::string_view{line.begin(), line.begin() + pos};
-        result.second = std::string_view{line.begin() + pos + 1, line.end()};
+        result.first = line.substr(0, pos);
+        result.second = line.substr(pos + separator.size());
     }
 
     return result;
@@ -48,6 +50,86 @@ TEST_CASE("split")
     CHECK(split(s4) == std::pair{""sv, "434"sv});
 }
 
+TEST_CASE("split_fields")
+{
+    SECTION("many fields")
+    {
+        std::string line = "1/one/jeden/eins/un/uno/один/1.0/I/0b1/0x1/001/one more";
+        auto result = fields::split_fields(line);
+
+        REQUIRE(result.size() == 13);
+        CHECK(result[0] == "1"sv);
+        CHECK(result[6] == "один"sv);
+        CHECK(result[12] == "one more"sv);
+        CHECK(result[12].data() == line.data() + line.find("one more")); // views into the original line
+    }
+
+    SECTION("empty fields")
+    {
+        CHECK(std::ranges::equal(fields::split_fields("//"), std::array{""sv, ""sv, ""sv}));
+        CHECK(std::ranges::equal(fields::split_fields(""), std::array{""sv}));
+        CHECK(std::ranges::equal(fields::split_fields("4343"), std::array{"4343"sv}));
+    }
+
+    SECTION("custom separator")
+    {
+        CHECK(std::ranges::equal(fields::split_fields("a;b;;c", ';'), std::array{"a"sv, "b"sv, ""sv, "c"sv}));
+    }
+
+    SECTION("more fields than capacity - the last field holds the rest of the line")
+    {
+        CHECK(std::ranges::equal(fields::split_fields<3>("a/b/c/d/e"), std::array{"a"sv, "b"sv, "c/d/e"sv}));
+    }
+
+    SECTION("same result as split for two fields")
+    {
+        for (std::string_view line : {"324/44"sv, "345/"sv, "/434"sv})
+        {
+            auto result = fields::split_fields(line);
+            CHECK(split(line) == std::pair{result[0], result[1]});
+        }
+    }
+}
+
+TEST_CASE("for_each_record")
+{
+    std::string buffer;
+    for (int i = 0; i < 1000; ++i)
+        buffer += std::to_string(i) + "/name_" + std::to_string(i) + "/" + std::to_string(i * i) + "\n";
+    buffer += "last/record"; // no trailing new line
+
+    size_t count = 0;
+    bool all_valid = true;
+
+    fields::for_each_record(buffer, '/', [&](const auto& record) {
+        if (count < 1000)
+        {
+            all_valid = all_valid && record.size() == 3
+                && record[0] == std::to_string(count)
+                && record[1] == "name_" + std::to_string(count)
+                && record[2] == std::to_string(count * count);
+        }
+        else
+        {
+            all_valid = all_valid && std::ranges::equal(record, std::array{"last"sv, "record"sv});
+        }
+        ++count;
+    });
+
+    CHECK(count == 1001);
+    CHECK(all_valid);
+
+    SECTION("separator at the end of the buffer - the last record has an empty field")
+    {
+        std::vector<std::vector<std::string_view>> records;
+        fields::for_each_record("1/one\n2/"sv, '/', [&](const auto& record) { records.emplace_back(record.begin(), record.end()); });
+
+        REQUIRE(records.size() == 2);
+        CHECK(records[0] == std::vector{"1"sv, "one"sv});
+        CHECK(records[1] == std::vector{"2"sv, ""sv});
+    }
+}
+
 //template <std::ranges::range TRng>
 void print_all(std::ranges::view auto rng)
 {
@@ -100,3 +182,49 @@ TEST_CASE("Exercise - ranges")
     print_all(result);
 }
 
+
+TEST_CASE("Exercise - ranges - bulk parsing of records")
+{
+    const std::string buffer = "# Comment 1\n# Comment 2\n1/one\n2/two\n\n3/three\n4/four\n5/five\n\n\n6/six";
+
+    auto table = records::parse_records(buffer);
+
+    auto expected_ids = {1, 2, 3, 4, 5, 6};
+    auto expected_names = {"one"sv, "two"sv, "three"sv, "four"sv, "five"sv, "six"sv};
+
+    CHECK(std::ranges::equal(table.ids, expected_ids));
+    CHECK(std::ranges::equal(table.names(), expected_names));
+    CHECK(table.malformed_lines == 0);
+
+    SECTION("comments are skipped only at the beginning")
+    {
+        auto table = records::parse_records("# header\n1/one\n# not a comment\n2/two\nx/bad id\n");
+
+        CHECK(std::ranges::equal(table.ids, std::array{1, 2}));
+        CHECK(table.malformed_lines == 2);
+    }
+
+    SECTION("separator at the end of the buffer - the last record has an empty name")
+    {
+        auto table = records::parse_records("1/one\n2/"sv);
+
+        CHECK(std::ranges::equal(table.ids, std::array{1, 2}));
+        CHECK(std::ranges::equal(table.names(), std::array{"one"sv, ""sv}));
+        CHECK(table.malformed_lines == 0);
+    }
+}
+
+TEST_CASE("bulk parsing of records - multithreaded")
+{
+    std::string buffer = "# generated records\n";
+    for (int i = 0; i < 200'000; ++i)
+        buffer += std::to_string(i) + "/name_" + std::to_string(i) + (i % 1000 == 0 ? "\n\n" : "\n");
+
+    auto single_threaded = records::parse_records(buffer, 1);
+    auto multi_threaded = records::parse_records(buffer, 8);
+
+    REQUIRE(single_threaded.size() == 200'000);
+    CHECK(std::ranges::equal(multi_threaded.ids, single_threaded.ids));
+    CHECK(std::ranges::equal(multi_threaded.names(), single_threaded.names()));
+    CHECK(multi_threaded.name(199'999) == "name_199999"sv);
+}
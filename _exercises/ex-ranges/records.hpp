@@ -0,0 +1,152 @@
+#ifndef RECORDS_HPP
+#define RECORDS_HPP
+
+#include "fields.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace records
+{
+    // "id/name" records stored as columns - names are offsets into the parsed buffer
+    struct RecordTable
+    {
+        std::string_view buffer = {};
+        std::vector<int64_t> ids = {};
+        std::vector<uint64_t> name_offsets = {};
+        std::vector<uint32_t> name_lengths = {};
+        size_t malformed_lines = 0; // lines without a separator or with an invalid id
+
+        size_t size() const noexcept
+        {
+            return ids.size();
+        }
+
+        std::string_view name(size_t index) const noexcept
+        {
+            return buffer.substr(name_offsets[index], name_lengths[index]);
+        }
+
+        auto names() const
+        {
+            return std::views::iota(size_t{0}, size()) | std::views::transform([this](size_t i) { return name(i); });
+        }
+    };
+
+    namespace details
+    {
+        constexpr size_t min_chunk_size = 1 << 20;
+
+        inline std::string_view next_line(std::string_view text, size_t pos) noexcept
+        {
+            const size_t end = text.find('\n', pos);
+            return text.substr(pos, end == std::string_view::npos ? text.size() - pos : end - pos);
+        }
+
+        // the same as drop_while(starts_with("#")) on lines - comments are allowed only at the beginning
+        inline size_t skip_leading_comments(std::string_view text) noexcept
+        {
+            size_t pos = 0;
+
+            while (pos < text.size())
+            {
+                std::string_view line = next_line(text, pos);
+                if (!line.starts_with('#'))
+                    break;
+                pos += line.size() + 1;
+            }
+
+            return std::min(pos, text.size());
+        }
+
+        // moves pos forward to the beginning of the next line (or to the end of text)
+        inline size_t align_to_line(std::string_view text, size_t pos) noexcept
+        {
+            if (pos == 0 || pos >= text.size())
+                return std::min(pos, text.size());
+
+            const size_t new_line = text.find('\n', pos - 1);
+            return new_line == std::string_view::npos ? text.size() : new_line + 1;
+        }
+
+        inline void parse_chunk(std::string_view buffer, size_t begin, size_t end, RecordTable& table)
+        {
+            fields::for_each_record<2>(buffer.substr(begin, end - begin), '/', [&](const auto& record) {
+                if (record.size() == 1 && record[0].empty()) // blank lines are filtered out
+                    return;
+
+                int64_t id{};
+                std::string_view id_field = record[0];
+                const auto [ptr, ec] = std::from_chars(id_field.data(), id_field.data() + id_field.size(), id);
+
+                if (record.size() != 2 || ec != std::errc{} || ptr != id_field.data() + id_field.size())
+                {
+                    ++table.malformed_lines;
+                    return;
+                }
+
+                table.ids.push_back(id);
+                table.name_offsets.push_back(static_cast<uint64_t>(record[1].data() - buffer.data()));
+                table.name_lengths.push_back(static_cast<uint32_t>(record[1].size()));
+            });
+        }
+    } // namespace details
+
+    // parses "id/name" lines in parallel ("id/" gives an empty name) - the buffer must outlive the returned table
+    inline RecordTable parse_records(std::string_view buffer, unsigned thread_count = std::thread::hardware_concurrency())
+    {
+        const size_t records_begin = details::skip_leading_comments(buffer);
+        const size_t records_size = buffer.size() - records_begin;
+
+        thread_count = static_cast<unsigned>(std::clamp<size_t>(records_size / details::min_chunk_size, 1, std::max(thread_count, 1u)));
+
+        std::vector<size_t> bounds(thread_count + 1);
+        for (unsigned i = 0; i <= thread_count; ++i)
+            bounds[i] = details::align_to_line(buffer, records_begin + records_size * i / thread_count);
+
+        std::vector<RecordTable> partial_tables(thread_count);
+
+        {
+            std::vector<std::jthread> workers;
+            workers.reserve(thread_count - 1);
+
+            for (unsigned i = 1; i < thread_count; ++i)
+                workers.emplace_back([&, i] { details::parse_chunk(buffer, bounds[i], bounds[i + 1], partial_tables[i]); });
+
+            details::parse_chunk(buffer, bounds[0], bounds[1], partial_tables[0]);
+        } // join
+
+        if (thread_count == 1)
+        {
+            partial_tables.front().buffer = buffer;
+            return std::move(partial_tables.front());
+        }
+
+        RecordTable table{.buffer = buffer};
+
+        size_t total_size = 0;
+        for (const auto& partial : partial_tables)
+            total_size += partial.size();
+
+        table.ids.reserve(total_size);
+        table.name_offsets.reserve(total_size);
+        table.name_lengths.reserve(total_size);
+
+        for (const auto& partial : partial_tables)
+        {
+            table.ids.insert(table.ids.end(), partial.ids.begin(), partial.ids.end());
+            table.name_offsets.insert(table.name_offsets.end(), partial.name_offsets.begin(), partial.name_offsets.end());
+            table.name_lengths.insert(table.name_lengths.end(), partial.name_lengths.begin(), partial.name_lengths.end());
+            table.malformed_lines += partial.malformed_lines;
+        }
+
+        return table;
+    }
+} // namespace records
+
+#endif
@@ -1,3 +1,4 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <iostream>
 #include <vector>
@@ -6,6 +7,15 @@
 #include <ranges>
 #include <algorithm>
 #include <numeric>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <thread>
+#include <helpers.hpp>
+#include "distinct.hpp"
+#include "lookup_table.hpp"
+#include "sketches.hpp"
+#include "string_kernels.hpp"
 
 using namespace std::literals;
 
@@ -40,20 +50,8 @@ TEST_CASE("consteval")
 
 constexpr int len(const char* s)
 {
-    if (std::is_constant_evaluated()) // C++20
-    //if consteval // C++23
-    {
-        // compile-time friendly code
-        int idx = 0;
-
-        while (s[idx] != '\0')
-            ++idx;
-        return idx;
-    }
-    else
-    {
-        return std::strlen(s); // function called at runtime
-    }
+    // strings::length() uses `if consteval` (C++23) - byte loop at compile time, SIMD kernel at runtime
+    return static_cast<int>(strings::length(s));
 }
 
 constexpr int memory_safe()
@@ -76,6 +74,104 @@ TEST_CASE("constexpr extensions")
     constexpr int result = memory_safe();
 }
 
+TEST_CASE("string kernels")
+{
+    static_assert(strings::length("abc") == 3);
+    static_assert(strings::find("324/44", '/') == 3);
+    static_assert(strings::find("Hello, World", "World") == 7);
+    static_assert(strings::compare("abc", "abd") == std::strong_ordering::less);
+    static_assert(strings::iequals("Gadget", "gADGET"));
+
+    std::mt19937 rnd{665};
+    auto random_text = [&](size_t size) {
+        std::string text(size, ' ');
+        std::ranges::generate(text, [&] { return static_cast<char>('A' + rnd() % 4); });
+        return text;
+    };
+
+    SECTION("length - all alignments and sizes")
+    {
+        std::string buffer(200, 'x');
+        for (size_t offset = 0; offset < 40; ++offset)
+        {
+            for (size_t size = 0; size < 100; ++size)
+            {
+                buffer[offset + size] = '\0';
+                CHECK(strings::length(buffer.data() + offset) == size);
+                buffer[offset + size] = 'x';
+            }
+        }
+    }
+
+    SECTION("find byte & substring - the same results as std::string_view")
+    {
+        for (size_t size = 0; size < 300; size += 7)
+        {
+            const std::string text = random_text(size);
+            const std::string pattern = random_text(1 + size % 5);
+
+            CHECK(strings::find(text, 'D') == std::string_view{text}.find('D'));
+            CHECK(strings::find(text, 'Z') == std::string_view::npos);
+            CHECK(strings::find(text, pattern) == std::string_view{text}.find(pattern));
+            CHECK(strings::find(text, pattern, size / 2) == std::string_view{text}.find(pattern, size / 2));
+            CHECK(strings::find(text, "") == 0);
+        }
+    }
+
+    SECTION("find - positions at and past the end of the text")
+    {
+        static_assert(strings::find("abc", 'c', 3) == strings::npos);
+        static_assert(strings::find("abc", "", 3) == 3);
+        static_assert(strings::find("abc", "", 4) == strings::npos);
+
+        for (size_t size : {0, 1, 15, 16, 17, 31, 32, 33, 100})
+        {
+            const std::string text = random_text(size);
+            const std::string_view view = text;
+
+            for (size_t pos : {size, size + 1, size + 100, strings::npos - 40, strings::npos - 1, strings::npos})
+            {
+                CHECK(strings::find(text, 'A', pos) == view.find('A', pos));
+                CHECK(strings::find(text, "AB", pos) == view.find("AB", pos));
+                CHECK(strings::find(text, "", pos) == view.find("", pos));
+            }
+        }
+    }
+
+    SECTION("three-way compare")
+    {
+        for (size_t size = 0; size < 200; size += 3)
+        {
+            std::string a = random_text(size);
+            std::string b = a;
+            CHECK(strings::compare(a, b) == std::strong_ordering::equal);
+
+            if (size > 0)
+            {
+                b[rnd() % size] = '\xff'; // unsigned comparison - the same as std::char_traits<char>
+                CHECK(strings::compare(a, b) == (std::string_view{a}.compare(b) <=> 0));
+                CHECK(strings::compare(b, a) == std::strong_ordering::greater);
+            }
+
+            CHECK(strings::compare(a, a + "A") == std::strong_ordering::less);
+        }
+    }
+
+    SECTION("case-insensitive equality")
+    {
+        std::string text = "The Quick Brown Fox Jumps Over The Lazy Dog @[`{ 0123456789";
+        std::string lower = text;
+        std::ranges::transform(lower, lower.begin(), [](char c) { return strings::scalar::to_lower(c); });
+
+        CHECK(strings::iequals(text, lower));
+        CHECK_FALSE(strings::iequals(text, lower + "!"));
+        CHECK_FALSE(strings::iequals("@[`{", "`{@[")); // characters next to letters are not folded
+
+        lower[40] = '#';
+        CHECK_FALSE(strings::iequals(text, lower));
+    }
+}
+
 template <size_t N>
 consteval auto create_powers()
 {
@@ -98,26 +194,94 @@ TEST_CASE("lookup table")
     constexpr auto squares = create_powers<100>();
 }
 
-template <std::ranges::input_range... TRng_>
-constexpr auto avg_for_unique(const TRng_&... rng)
+constexpr double pi = 3.141592653589793;
+
+constexpr double sin_series(double x)
 {
-    using TElement = std::common_type_t<std::ranges::range_value_t<TRng_>...>;
+    double term = x;
+    double sum = x;
+
+    for (int n = 1; n < 20; ++n)
+    {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
 
-    std::vector<TElement> vec;                            // empty vector
-    vec.reserve((rng.size() + ...));                      // reserve a buffer - fold expression C++17
-    (vec.insert(vec.end(), rng.begin(), rng.end()), ...); // fold expression C++17
+    return sum;
+}
 
-    // sort items
-    std::ranges::sort(vec); // std::sort(vec.begin(), vec.end());
+constexpr auto sin_lut = lut::make_lut<1024>(sin_series, lut::Domain{0.0, pi}); // stored in .rodata
 
-    // create span of unique_items
-    auto new_end = std::unique(vec.begin(), vec.end());
-    std::span unique_items{vec.begin(), new_end};
+TEST_CASE("generic lookup table")
+{
+    static_assert(sin_lut[0] == 0.0);
+    static_assert(sin_lut.linear(pi / 2) > 0.99999 && sin_lut.linear(pi / 2) <= 1.0);
+    static_assert(alignof(decltype(sin_lut)) == lut::cache_line_size);
+
+    SECTION("interpolation")
+    {
+        for (double x = 0.0; x <= pi; x += 0.001)
+        {
+            CHECK(std::abs(sin_lut.linear(x) - sin_series(x)) < 2e-6);
+            CHECK(std::abs(sin_lut.cubic(x) - sin_series(x)) < 1e-8);
+        }
+    }
+
+    SECTION("values outside of domain are clamped")
+    {
+        CHECK(sin_lut.linear(-1.0) == sin_lut[0]);
+        CHECK(std::abs(sin_lut.cubic(10.0) - sin_lut[1023]) < 1e-12);
+        CHECK(sin_lut.nearest(10.0) == sin_lut[1023]);
+
+        constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+        CHECK(sin_lut.nearest(nan) == sin_lut[0]);
+        CHECK(sin_lut.linear(nan) == sin_lut[0]);
+        CHECK(sin_lut.cubic(nan) == sin_lut[0]);
+
+        std::vector<double> xs(9, nan), results(xs.size());
+        sin_lut.evaluate(xs, results);
+        CHECK(std::ranges::all_of(results, [](double r) { return r == sin_lut[0]; }));
+    }
+
+    SECTION("batched evaluation")
+    {
+        std::vector<double> xs(1003);
+        for (size_t i = 0; i < xs.size(); ++i)
+            xs[i] = -0.5 + 4.0 * static_cast<double>(i) / static_cast<double>(xs.size());
+
+        std::vector<double> results(xs.size());
+        sin_lut.evaluate(xs, results);
+
+        for (size_t i = 0; i < xs.size(); ++i)
+            CHECK(results[i] == sin_lut.linear(xs[i]));
+    }
+
+    SECTION("float tables")
+    {
+        constexpr auto cube_lut = lut::make_lut<256>([](float x) { return x * x * x; }, lut::Domain{-1.0f, 1.0f});
 
-    // calculate sum of unique items
-    auto sum = std::accumulate(unique_items.begin(), unique_items.end(), TElement{});
+        std::vector<float> xs(1000);
+        for (size_t i = 0; i < xs.size(); ++i)
+            xs[i] = -1.0f + 2.0f * static_cast<float>(i) / static_cast<float>(xs.size());
+
+        std::vector<float> results(xs.size());
+        cube_lut.evaluate(xs, results);
+
+        for (size_t i = 0; i < xs.size(); ++i)
+        {
+            CHECK(results[i] == cube_lut.linear(xs[i]));
+            CHECK(std::abs(cube_lut.cubic(xs[i]) - xs[i] * xs[i] * xs[i]) < 1e-4f);
+        }
+    }
+}
+
+template <std::ranges::input_range... TRng_>
+constexpr auto avg_for_unique(const TRng_&... rng)
+{
+    // distinct items are found with a bitmap (small integral domains) or a hash set - no sorting required
+    const auto [sum, count] = distinct::sum_distinct(rng...);
 
-    return sum / static_cast<double>(unique_items.size());
+    return sum / static_cast<double>(count);
 }
 
 TEST_CASE("constexpr - lookup table")
@@ -130,4 +294,186 @@ TEST_CASE("constexpr - lookup table")
     constexpr auto avg = avg_for_unique(lst1, lst2);
 
     std::cout << "AVG: " << avg << "\n";
-}
\ No newline at end of file
+}
+
+template <std::ranges::input_range... TRng_>
+auto avg_for_unique_with_sort(const TRng_&... rng)
+{
+    using TElement = std::common_type_t<std::ranges::range_value_t<TRng_>...>;
+
+    std::vector<TElement> vec;
+    (vec.insert(vec.end(), rng.begin(), rng.end()), ...);
+    std::ranges::sort(vec);
+    auto new_end = std::unique(vec.begin(), vec.end());
+
+    return std::accumulate(vec.begin(), new_end, 0LL) / static_cast<double>(new_end - vec.begin());
+}
+
+TEST_CASE("avg_for_unique - distinct engine")
+{
+    static_assert(avg_for_unique(std::array{1, 2, 3, 4, 5}, std::array{5, 6, 7, 8, 9}) == 5.0);
+    static_assert(avg_for_unique(std::array{-1'000'000'000, 1'000'000'000, 1'000'000'000}) == 0.0); // hash set in constant evaluation
+    static_assert(avg_for_unique(std::array{0.5, 0.5, -0.0, 0.0, 2.5}) == 1.0);
+
+    SECTION("dense bitmap")
+    {
+        const auto data = helpers::create_numeric_dataset<10'000>(42);
+        CHECK(avg_for_unique(data) == avg_for_unique_with_sort(data));
+
+        distinct::DenseBitmapSet<int> set{-100, 100};
+        CHECK(set.insert(-100));
+        CHECK(set.insert(100));
+        CHECK_FALSE(set.insert(100));
+        CHECK(set.contains(-100));
+        CHECK_FALSE(set.contains(0));
+        CHECK(set.size() == 2);
+    }
+
+    SECTION("hash set")
+    {
+        const auto data = helpers::create_numeric_dataset<10'000>(665, -1'000'000'000, 1'000'000'000);
+        CHECK(avg_for_unique(data) == avg_for_unique_with_sort(data));
+    }
+
+    SECTION("large inputs - multithreaded")
+    {
+        std::vector<int> small_domain(3'000'000);
+        std::vector<long long> large_domain(3'000'000);
+        std::mt19937_64 rnd{42};
+        std::ranges::generate(small_domain, [&] { return static_cast<int>(rnd() % 100'000) - 50'000; });
+        std::ranges::generate(large_domain, [&] { return static_cast<long long>(rnd() % 2'000'000) * 1'000'003; });
+
+        CHECK(avg_for_unique(small_domain) == avg_for_unique_with_sort(small_domain));
+        CHECK(avg_for_unique(large_domain, small_domain) == avg_for_unique_with_sort(large_domain, small_domain));
+
+        const auto expected_dense = distinct::sum_distinct(distinct::Threads{1}, small_domain);
+        const auto parallel_dense = distinct::sum_distinct(distinct::Threads{8}, small_domain);
+        CHECK(parallel_dense.sum == expected_dense.sum);
+        CHECK(parallel_dense.count == expected_dense.count);
+
+        // fewer bitmap words than threads - some threads get no range of values
+        std::vector<int> tiny_domain(small_domain.size());
+        std::ranges::transform(small_domain, tiny_domain.begin(), [](int x) { return x % 100; });
+        const auto expected_tiny = distinct::sum_distinct(distinct::Threads{1}, tiny_domain);
+        const auto parallel_tiny = distinct::sum_distinct(distinct::Threads{8}, tiny_domain);
+        CHECK(parallel_tiny.sum == expected_tiny.sum);
+        CHECK(parallel_tiny.count == expected_tiny.count);
+
+        const auto expected_hash = distinct::sum_distinct(distinct::Threads{1}, large_domain);
+        const auto parallel_hash = distinct::sum_distinct(distinct::Threads{8}, large_domain);
+        CHECK(parallel_hash.sum == expected_hash.sum);
+        CHECK(parallel_hash.count == expected_hash.count);
+
+        const auto [sum, count] = distinct::sum_distinct(distinct::Threads{3}, small_domain, std::views::iota(0, 100'000));
+        CHECK(count == 150'000);
+    }
+}
+
+TEST_CASE("sketches - approximate distinct count")
+{
+    const auto data = helpers::create_numeric_dataset<100'000>(42, -1'000'000, 1'000'000);
+    const auto exact_count = static_cast<double>(distinct::sum_distinct(data).count);
+
+    sketches::HyperLogLog<14> hll;
+    hll.add_range(data);
+
+    CHECK(std::abs(hll.estimate() - exact_count) / exact_count < 0.03);
+
+    SECTION("small number of distinct items")
+    {
+        const auto small_data = helpers::create_numeric_dataset<10'000>(42);
+
+        sketches::HyperLogLog<14> small_hll;
+        small_hll.add_range(small_data);
+
+        CHECK(std::abs(small_hll.estimate() - distinct::sum_distinct(small_data).count) < 2.0);
+    }
+
+    SECTION("merging sketches built by many threads")
+    {
+        constexpr size_t thread_count = 4;
+        std::vector<sketches::HyperLogLog<14>> partial_sketches(thread_count);
+        {
+            std::vector<std::jthread> workers;
+            for (size_t t = 0; t < thread_count; ++t)
+            {
+                workers.emplace_back([&, t] {
+                    partial_sketches[t].add_range(data | std::views::drop(t * data.size() / thread_count) | std::views::take(data.size() / thread_count));
+                });
+            }
+        }
+
+        sketches::HyperLogLog<14> merged;
+        for (const auto& partial : partial_sketches)
+            merged.merge(partial);
+
+        CHECK(merged.estimate() == hll.estimate());
+    }
+}
+
+TEST_CASE("sketches - approximate frequencies")
+{
+    const auto data = helpers::create_numeric_dataset<100'000>(665, 0, 10'000);
+
+    std::map<int, uint64_t> exact_frequencies;
+    for (int item : data)
+        ++exact_frequencies[item];
+
+    sketches::CountMinSketch<4096, 5> cms;
+    cms.add_range(data | std::views::take(50'000));
+
+    sketches::CountMinSketch<4096, 5> other_cms;
+    other_cms.add_range(data | std::views::drop(50'000));
+
+    cms.merge(other_cms);
+    REQUIRE(cms.total_count() == data.size());
+
+    // estimates never underestimate - the error bound holds only with probability 1 - delta for every item,
+    // so it is checked for the fraction of items (the dataset is generated from a fixed seed)
+    const double max_error = std::exp(1.0) / 4096 * static_cast<double>(data.size());
+    const double delta = std::exp(-5.0);
+    double total_error = 0.0;
+    bool never_underestimates = true;
+    size_t within_bound_count = 0;
+
+    for (const auto& [item, frequency] : exact_frequencies)
+    {
+        const uint64_t estimate = cms.estimate(item);
+        never_underestimates = never_underestimates && estimate >= frequency;
+        if (estimate >= frequency)
+        {
+            within_bound_count += static_cast<double>(estimate - frequency) <= max_error;
+            total_error += static_cast<double>(estimate - frequency);
+        }
+    }
+
+    CHECK(never_underestimates);
+    CHECK(static_cast<double>(within_bound_count) >= (1.0 - delta) * static_cast<double>(exact_frequencies.size()));
+    CHECK(total_error / static_cast<double>(exact_frequencies.size()) < max_error / 2);
+}
+
+TEST_CASE("sketches - throughput", "[.benchmark]")
+{
+    std::vector<int> data(1'000'000);
+    std::mt19937 rnd{42};
+    std::ranges::generate(data, [&] { return static_cast<int>(rnd() % 500'000); });
+
+    BENCHMARK("exact - avg_for_unique")
+    {
+        return avg_for_unique(data);
+    };
+
+    BENCHMARK("HyperLogLog")
+    {
+        sketches::HyperLogLog<14> hll;
+        hll.add_range(data);
+        return hll.estimate();
+    };
+
+    BENCHMARK("Count-Min")
+    {
+        sketches::CountMinSketch<4096, 5> cms;
+        cms.add_range(data);
+        return cms.estimate(42);
+    };
+}
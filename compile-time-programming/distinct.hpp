@@ -0,0 +1,419 @@
+#ifndef DISTINCT_HPP
+#define DISTINCT_HPP
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ranges>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace distinct
+{
+    constexpr uint64_t mix(uint64_t x) noexcept // splitmix64 finalizer
+    {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    template <typename T>
+    concept Hashable = (std::integral<T> || std::floating_point<T>) && sizeof(T) <= sizeof(uint64_t);
+
+    template <Hashable T>
+    constexpr uint64_t hash(T value) noexcept
+    {
+        if constexpr (std::integral<T>)
+        {
+            return mix(static_cast<uint64_t>(value));
+        }
+        else
+        {
+            using TBits = std::conditional_t<sizeof(T) == sizeof(uint32_t), uint32_t, uint64_t>;
+            return mix(std::bit_cast<TBits>(value == T{} ? T{} : value)); // -0.0 == 0.0
+        }
+    }
+
+    // set of integers from [min, max] - one bit per value
+    template <std::integral T>
+    class DenseBitmapSet
+    {
+        T min_;
+        std::vector<uint64_t> bits_;
+        size_t size_ = 0;
+
+    public:
+        constexpr DenseBitmapSet(T min, T max)
+            : min_{min}
+            , bits_(offset(max, min) / 64 + 1)
+        { }
+
+        constexpr bool insert(T value)
+        {
+            const uint64_t index = offset(value, min_);
+            const uint64_t mask = uint64_t{1} << (index % 64);
+            uint64_t& word = bits_[index / 64];
+
+            if (word & mask)
+                return false;
+
+            word |= mask;
+            ++size_;
+            return true;
+        }
+
+        constexpr bool contains(T value) const
+        {
+            const uint64_t index = offset(value, min_);
+            return (bits_[index / 64] >> (index % 64)) & 1;
+        }
+
+        constexpr size_t size() const noexcept
+        {
+            return size_;
+        }
+
+        // union of both sets - sets must be created for the same domain
+        constexpr void merge(const DenseBitmapSet& other, size_t first_word = 0, size_t last_word = std::numeric_limits<size_t>::max())
+        {
+            last_word = std::min(last_word, bits_.size());
+            for (size_t i = first_word; i < last_word; ++i)
+            {
+                size_ += std::popcount(other.bits_[i] & ~bits_[i]);
+                bits_[i] |= other.bits_[i];
+            }
+        }
+
+        template <typename TFunction>
+        constexpr void for_each(TFunction f) const
+        {
+            for (size_t i = 0; i < bits_.size(); ++i)
+                for_each_in_word(min_, i, bits_[i], f);
+        }
+
+        // calls f for every value of the bitmap word at word_index
+        template <typename TFunction>
+        static constexpr void for_each_in_word(T min, size_t word_index, uint64_t word, TFunction f)
+        {
+            for (; word != 0; word &= word - 1)
+                f(static_cast<T>(static_cast<uint64_t>(min) + word_index * 64 + std::countr_zero(word)));
+        }
+
+        static constexpr uint64_t offset(T value, T min) noexcept
+        {
+            return static_cast<uint64_t>(value) - static_cast<uint64_t>(min);
+        }
+    };
+
+    // open-addressing hash set with linear probing
+    template <Hashable T>
+    class HashSet
+    {
+        std::vector<T> keys_;
+        std::vector<uint8_t> used_;
+        size_t size_ = 0;
+
+    public:
+        constexpr explicit HashSet(size_t expected_size = 16)
+        {
+            rehash(std::bit_ceil(std::max<size_t>(expected_size * 2, 16)));
+        }
+
+        constexpr bool insert(T value)
+        {
+            if (2 * (size_ + 1) > keys_.size())
+                rehash(keys_.size() * 2);
+
+            if (!insert_unique(value))
+                return false;
+
+            ++size_;
+            return true;
+        }
+
+        constexpr bool contains(T value) const
+        {
+            const size_t mask = keys_.size() - 1;
+            for (size_t i = hash(value) & mask; used_[i]; i = (i + 1) & mask)
+            {
+                if (keys_[i] == value)
+                    return true;
+            }
+            return false;
+        }
+
+        constexpr size_t size() const noexcept
+        {
+            return size_;
+        }
+
+        template <typename TFunction>
+        constexpr void for_each(TFunction f) const
+        {
+            for (size_t i = 0; i < keys_.size(); ++i)
+            {
+                if (used_[i])
+                    f(keys_[i]);
+            }
+        }
+
+    private:
+        constexpr bool insert_unique(T value)
+        {
+            const size_t mask = keys_.size() - 1;
+            size_t i = hash(value) & mask;
+
+            for (; used_[i]; i = (i + 1) & mask)
+            {
+                if (keys_[i] == value)
+                    return false;
+            }
+
+            keys_[i] = value;
+            used_[i] = 1;
+            return true;
+        }
+
+        constexpr void rehash(size_t new_capacity)
+        {
+            std::vector<T> old_keys(new_capacity);
+            std::vector<uint8_t> old_used(new_capacity);
+            old_keys.swap(keys_);
+            old_used.swap(used_);
+
+            for (size_t i = 0; i < old_keys.size(); ++i)
+            {
+                if (old_used[i])
+                    insert_unique(old_keys[i]);
+            }
+        }
+    };
+
+    template <typename T>
+    using SumType = std::conditional_t<std::integral<T>, std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>, T>;
+
+    template <typename T>
+    struct SumCount
+    {
+        SumType<T> sum{};
+        size_t count = 0;
+
+        constexpr SumCount& operator+=(const SumCount& other) noexcept
+        {
+            sum += other.sum;
+            count += other.count;
+            return *this;
+        }
+    };
+
+    namespace details
+    {
+        // inputs larger than this are processed by many threads
+        constexpr size_t parallel_threshold = size_t{1} << 20;
+
+        // bitmap is used only if it is not larger than 8 bytes per input element
+        constexpr uint64_t max_dense_bits(size_t input_size) noexcept
+        {
+            return 64 * static_cast<uint64_t>(input_size) + (1 << 16);
+        }
+
+        template <typename T, typename TSet>
+        constexpr SumCount<T> sum_count(const TSet& set)
+        {
+            SumCount<T> result{.count = set.size()};
+            set.for_each([&](T value) { result.sum += value; });
+            return result;
+        }
+
+        template <typename T, typename... TRng>
+        constexpr void for_each_item(auto f, const TRng&... rng)
+        {
+            (..., std::ranges::for_each(rng, [&](const auto& item) { f(static_cast<T>(item)); }));
+        }
+
+        template <typename T, typename TSet, typename... TRng>
+        constexpr SumCount<T> sequential(TSet set, const TRng&... rng)
+        {
+            for_each_item<T>([&](T value) { set.insert(value); }, rng...);
+            return sum_count<T>(set);
+        }
+
+        // calls f(thread_index, items) for thread_count slices of all ranges
+        template <typename T, typename... TRng>
+        void parallel_slices(unsigned thread_count, auto f, const TRng&... rng)
+        {
+            std::vector<std::jthread> workers;
+            workers.reserve(thread_count);
+
+            for (unsigned t = 0; t < thread_count; ++t)
+            {
+                workers.emplace_back([&, t] {
+                    auto process_slice = [&](const auto& r) {
+                        using TDiff = std::ranges::range_difference_t<decltype(r)>;
+                        const auto size = static_cast<size_t>(std::ranges::size(r));
+                        auto first = std::ranges::begin(r) + static_cast<TDiff>(size * t / thread_count);
+                        auto last = std::ranges::begin(r) + static_cast<TDiff>(size * (t + 1) / thread_count);
+                        f(t, std::ranges::subrange(first, last));
+                    };
+                    (..., process_slice(rng));
+                });
+            }
+        }
+
+        // the domain is split into word-aligned value ranges - every thread scans all items and keeps only those of
+        // its own range, so the bitmaps of all threads together are as large as one bitmap of the whole domain
+        template <std::integral T, typename... TRng>
+        SumCount<T> parallel_dense(unsigned thread_count, T min, T max, const TRng&... rng)
+        {
+            const uint64_t last_offset = DenseBitmapSet<T>::offset(max, min);
+            const uint64_t word_count = last_offset / 64 + 1;
+            std::vector<SumCount<T>> partial_results(thread_count);
+
+            auto process_range = [&](unsigned t) {
+                const uint64_t first_word = word_count * t / thread_count;
+                const uint64_t last_word = word_count * (t + 1) / thread_count;
+                if (first_word == last_word)
+                    return;
+
+                const T low = static_cast<T>(static_cast<uint64_t>(min) + 64 * first_word);
+                const T high = static_cast<T>(static_cast<uint64_t>(min) + std::min(64 * last_word - 1, last_offset));
+
+                DenseBitmapSet<T> set{low, high};
+                for_each_item<T>([&](T value) {
+                    if (low <= value && value <= high)
+                        set.insert(value);
+                }, rng...);
+                partial_results[t] = sum_count<T>(set);
+            };
+
+            {
+                std::vector<std::jthread> workers;
+                for (unsigned t = 1; t < thread_count; ++t)
+                    workers.emplace_back(process_range, t);
+                process_range(0);
+            }
+
+            SumCount<T> result;
+            for (const auto& partial : partial_results)
+                result += partial;
+            return result;
+        }
+
+        // items are scattered into partitions by hash - every partition is deduplicated by one thread
+        template <Hashable T, typename... TRng>
+        SumCount<T> parallel_hash(unsigned thread_count, size_t total_size, const TRng&... rng)
+        {
+            const unsigned partition_count = thread_count;
+            std::vector<std::vector<std::vector<T>>> partitions(thread_count, std::vector<std::vector<T>>(partition_count));
+
+            parallel_slices<T>(thread_count, [&](unsigned t, auto slice) {
+                auto& buckets = partitions[t];
+                for (auto& bucket : buckets)
+                    bucket.reserve(total_size / thread_count / partition_count + 16);
+
+                for (const auto& item : slice)
+                {
+                    const T value = static_cast<T>(item);
+                    buckets[(hash(value) >> 32) % partition_count].push_back(value);
+                }
+            }, rng...);
+
+            std::vector<SumCount<T>> partial_results(partition_count);
+            {
+                std::vector<std::jthread> workers;
+                for (unsigned p = 0; p < partition_count; ++p)
+                {
+                    workers.emplace_back([&, p] {
+                        size_t partition_size = 0;
+                        for (const auto& buckets : partitions)
+                            partition_size += buckets[p].size();
+
+                        HashSet<T> set{partition_size};
+                        for (const auto& buckets : partitions)
+                            for (const T& value : buckets[p])
+                                set.insert(value);
+
+                        partial_results[p] = sum_count<T>(set);
+                    });
+                }
+            }
+
+            SumCount<T> result;
+            for (const auto& partial : partial_results)
+                result += partial;
+            return result;
+        }
+    } // namespace details
+
+    // upper limit of threads used for large inputs
+    struct Threads
+    {
+        unsigned count = std::max(std::thread::hardware_concurrency(), 1u);
+    };
+
+    template <typename... TRng>
+    concept DistinctInputs = (sizeof...(TRng) > 0) && (... && std::ranges::input_range<TRng>)
+        && Hashable<std::common_type_t<std::ranges::range_value_t<TRng>...>>;
+
+    // sum and count of distinct items of all ranges
+    template <typename... TRng>
+        requires DistinctInputs<TRng...>
+    constexpr auto sum_distinct(Threads threads, const TRng&... rng)
+    {
+        using T = std::common_type_t<std::ranges::range_value_t<TRng>...>;
+
+        constexpr bool all_sized = (... && std::ranges::sized_range<TRng>);
+        size_t total_size = 0;
+        if constexpr (all_sized)
+            total_size = (... + static_cast<size_t>(std::ranges::size(rng)));
+
+        constexpr bool can_run_in_parallel = (... && std::ranges::random_access_range<TRng>) && all_sized;
+        unsigned thread_count = 1;
+        if (!std::is_constant_evaluated() && can_run_in_parallel && total_size >= details::parallel_threshold)
+            thread_count = std::max(threads.count, 1u);
+
+        if constexpr (std::integral<T> && (... && std::ranges::forward_range<TRng>))
+        {
+            T min = std::numeric_limits<T>::max();
+            T max = std::numeric_limits<T>::min();
+            size_t count = 0;
+            details::for_each_item<T>([&](T value) { min = std::min(min, value); max = std::max(max, value); ++count; }, rng...);
+
+            if (count == 0)
+                return SumCount<T>{};
+
+            if (DenseBitmapSet<T>::offset(max, min) < details::max_dense_bits(count))
+            {
+                if constexpr (can_run_in_parallel)
+                {
+                    if (thread_count > 1)
+                        return details::parallel_dense(thread_count, min, max, rng...);
+                }
+                return details::sequential<T>(DenseBitmapSet<T>{min, max}, rng...);
+            }
+        }
+
+        if constexpr (can_run_in_parallel)
+        {
+            if (thread_count > 1)
+                return details::parallel_hash<T>(thread_count, total_size, rng...);
+        }
+        return details::sequential<T>(HashSet<T>{total_size}, rng...);
+    }
+
+    template <typename... TRng>
+        requires DistinctInputs<TRng...>
+    constexpr auto sum_distinct(const TRng&... rng)
+    {
+        return sum_distinct(Threads{.count = std::is_constant_evaluated() ? 1u : Threads{}.count}, rng...);
+    }
+} // namespace distinct
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef LOOKUP_TABLE_HPP
+#define LOOKUP_TABLE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+#include <cpu_features.hpp>
+
+namespace lut
+{
+    constexpr size_t cache_line_size = 64;
+
+    template <std::floating_point T>
+    struct Domain
+    {
+        T min;
+        T max;
+    };
+
+    template <std::floating_point T, size_t N>
+    struct LookupTable
+    {
+        static_assert(N >= 2, "table needs at least two samples to interpolate");
+        static_assert(N <= INT32_MAX, "indexes must fit in int32 for gathers");
+
+        alignas(cache_line_size) std::array<T, N> values{};
+        Domain<T> domain{};
+        T step{};
+        T inv_step{};
+
+        static constexpr size_t size() noexcept
+        {
+            return N;
+        }
+
+        constexpr T operator[](size_t index) const noexcept
+        {
+            return values[index];
+        }
+
+        // value of the sample closest to x
+        constexpr T nearest(T x) const noexcept
+        {
+            const T t = position(x);
+            return values[static_cast<size_t>(t + T(0.5))];
+        }
+
+        constexpr T linear(T x) const noexcept
+        {
+            const T t = position(x);
+            const size_t i = std::min(static_cast<size_t>(t), N - 2);
+            const T frac = t - static_cast<T>(i);
+
+            return values[i] + frac * (values[i + 1] - values[i]);
+        }
+
+        // Catmull-Rom spline through the neighbouring samples (linearly extrapolated at the ends of the table)
+        constexpr T cubic(T x) const noexcept
+        {
+            const T t = position(x);
+            const size_t i = std::min(static_cast<size_t>(t), N - 2);
+            const T frac = t - static_cast<T>(i);
+
+            const T p1 = values[i];
+            const T p2 = values[i + 1];
+            const T p0 = (i == 0) ? T(2) * p1 - p2 : values[i - 1];
+            const T p3 = (i + 2 == N) ? T(2) * p2 - p1 : values[i + 2];
+
+            const T a = -p0 + T(3) * p1 - T(3) * p2 + p3;
+            const T b = T(2) * p0 - T(5) * p1 + T(4) * p2 - p3;
+            const T c = -p0 + p2;
+
+            return p1 + T(0.5) * frac * (c + frac * (b + frac * a));
+        }
+
+        // batched linear interpolation - uses AVX2 gathers when available
+        void evaluate(std::span<const T> xs, std::span<T> results) const noexcept
+        {
+            assert(xs.size() <= results.size());
+
+            size_t processed = 0;
+#ifdef CPU_HAS_AVX_DISPATCH
+            if (helpers::cpu::has_avx2)
+                processed = evaluate_avx2(xs, results);
+#endif
+            for (size_t i = processed; i < xs.size(); ++i)
+                results[i] = linear(xs[i]);
+        }
+
+    private:
+        // fractional index of x clamped to [0, N - 1] - NaN maps to 0 (as max(t, 0) does in the AVX2 path)
+        constexpr T position(T x) const noexcept
+        {
+            const T t = (x - domain.min) * inv_step;
+            return !(t >= T(0)) ? T(0) : std::min(t, static_cast<T>(N - 1));
+        }
+
+#ifdef CPU_HAS_AVX_DISPATCH
+        // returns the number of processed items - the rest is left for the scalar loop
+        CPU_TARGET_AVX2 size_t evaluate_avx2(std::span<const T> xs, std::span<T> results) const noexcept
+        {
+            size_t i = 0;
+
+            if constexpr (std::same_as<T, double>)
+            {
+                const __m256d min = _mm256_set1_pd(domain.min);
+                const __m256d inv_step = _mm256_set1_pd(this->inv_step);
+                const __m256d zero = _mm256_setzero_pd();
+                const __m256d last = _mm256_set1_pd(static_cast<double>(N - 1));
+                const __m128i last_segment = _mm_set1_epi32(static_cast<int>(N - 2));
+                const __m256d all_lanes = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+
+                for (; i + 4 <= xs.size(); i += 4)
+                {
+                    __m256d t = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(xs.data() + i), min), inv_step);
+                    t = _mm256_min_pd(_mm256_max_pd(t, zero), last);
+
+                    const __m128i index = _mm_min_epi32(_mm256_cvttpd_epi32(t), last_segment);
+                    const __m256d frac = _mm256_sub_pd(t, _mm256_cvtepi32_pd(index));
+                    // masked gathers with an explicit source - GCC warns about the undefined one of _mm256_i32gather_pd
+                    const __m256d v0 = _mm256_mask_i32gather_pd(zero, values.data(), index, all_lanes, sizeof(double));
+                    const __m256d v1 = _mm256_mask_i32gather_pd(zero, values.data() + 1, index, all_lanes, sizeof(double));
+
+                    _mm256_storeu_pd(results.data() + i, _mm256_add_pd(v0, _mm256_mul_pd(frac, _mm256_sub_pd(v1, v0))));
+                }
+            }
+            else if constexpr (std::same_as<T, float>)
+            {
+                const __m256 min = _mm256_set1_ps(domain.min);
+                const __m256 inv_step = _mm256_set1_ps(this->inv_step);
+                const __m256 zero = _mm256_setzero_ps();
+                const __m256 last = _mm256_set1_ps(static_cast<float>(N - 1));
+                const __m256i last_segment = _mm256_set1_epi32(static_cast<int>(N - 2));
+
+                for (; i + 8 <= xs.size(); i += 8)
+                {
+                    __m256 t = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(xs.data() + i), min), inv_step);
+                    t = _mm256_min_ps(_mm256_max_ps(t, zero), last);
+
+                    const __m256i index = _mm256_min_epi32(_mm256_cvttps_epi32(t), last_segment);
+                    const __m256 frac = _mm256_sub_ps(t, _mm256_cvtepi32_ps(index));
+                    const __m256 v0 = _mm256_i32gather_ps(values.data(), index, sizeof(float));
+                    const __m256 v1 = _mm256_i32gather_ps(values.data() + 1, index, sizeof(float));
+
+                    _mm256_storeu_ps(results.data() + i, _mm256_add_ps(v0, _mm256_mul_ps(frac, _mm256_sub_ps(v1, v0))));
+                }
+            }
+
+            return i;
+        }
+#endif
+    };
+
+    // samples f at N evenly spaced points of the domain (both ends included)
+    template <size_t N, typename F, std::floating_point T>
+        requires std::regular_invocable<F, T> && std::convertible_to<std::invoke_result_t<F, T>, T>
+    consteval LookupTable<T, N> make_lut(F f, Domain<T> domain)
+    {
+        LookupTable<T, N> table{};
+
+        table.domain = domain;
+        table.step = (domain.max - domain.min) / static_cast<T>(N - 1);
+        table.inv_step = static_cast<T>(N - 1) / (domain.max - domain.min);
+
+        for (size_t i = 0; i < N; ++i)
+        {
+            const T x = (i == N - 1) ? domain.max : domain.min + static_cast<T>(i) * table.step;
+            table.values[i] = static_cast<T>(f(x));
+        }
+
+        return table;
+    }
+} // namespace lut
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef SKETCHES_HPP
+#define SKETCHES_HPP
+
+#include "distinct.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <vector>
+
+namespace sketches
+{
+    // approximate count of distinct items - standard error ~ 1.04 / sqrt(2^Precision)
+    template <unsigned Precision = 14>
+    class HyperLogLog
+    {
+        static_assert(Precision >= 4 && Precision <= 18);
+
+        static constexpr size_t register_count = size_t{1} << Precision;
+
+        std::vector<uint8_t> registers_ = std::vector<uint8_t>(register_count);
+
+    public:
+        template <distinct::Hashable T>
+        void add(T item) noexcept
+        {
+            add_hash(distinct::hash(item));
+        }
+
+        void add_hash(uint64_t hash) noexcept
+        {
+            const size_t index = hash >> (64 - Precision);
+            const uint64_t rest = (hash << Precision) | (uint64_t{1} << (Precision - 1)); // guard bit limits the rank
+            const auto rank = static_cast<uint8_t>(std::countl_zero(rest) + 1);
+
+            registers_[index] = std::max(registers_[index], rank);
+        }
+
+        template <std::ranges::input_range TRng>
+        void add_range(TRng&& rng)
+        {
+            for (const auto& item : rng)
+                add(item);
+        }
+
+        // sketch of the union of both inputs
+        void merge(const HyperLogLog& other) noexcept
+        {
+            for (size_t i = 0; i < register_count; ++i)
+                registers_[i] = std::max(registers_[i], other.registers_[i]);
+        }
+
+        double estimate() const noexcept
+        {
+            constexpr double m = static_cast<double>(register_count);
+            constexpr double alpha = 0.7213 / (1.0 + 1.079 / m);
+
+            double harmonic_sum = 0.0;
+            size_t zero_registers = 0;
+            for (uint8_t rank : registers_)
+            {
+                harmonic_sum += std::ldexp(1.0, -rank);
+                zero_registers += (rank == 0);
+            }
+
+            const double raw_estimate = alpha * m * m / harmonic_sum;
+
+            if (raw_estimate <= 2.5 * m && zero_registers != 0) // small range correction - linear counting
+                return m * std::log(m / static_cast<double>(zero_registers));
+
+            return raw_estimate;
+        }
+
+        static constexpr size_t memory_size() noexcept
+        {
+            return register_count;
+        }
+    };
+
+    // approximate frequencies - estimates never underestimate and overestimate by at most e/Width * total_count
+    // with probability 1 - exp(-Depth)
+    template <size_t Width = 2048, size_t Depth = 5>
+    class CountMinSketch
+    {
+        static_assert(std::has_single_bit(Width), "width must be a power of 2");
+
+        std::vector<uint64_t> counters_ = std::vector<uint64_t>(Width * Depth);
+        uint64_t total_count_ = 0;
+
+    public:
+        template <distinct::Hashable T>
+        void add(T item, uint64_t count = 1) noexcept
+        {
+            const uint64_t hash = distinct::hash(item);
+            for (size_t row = 0; row < Depth; ++row)
+                counters_[row * Width + column(hash, row)] += count;
+            total_count_ += count;
+        }
+
+        template <std::ranges::input_range TRng>
+        void add_range(TRng&& rng)
+        {
+            for (const auto& item : rng)
+                add(item);
+        }
+
+        template <distinct::Hashable T>
+        uint64_t estimate(T item) const noexcept
+        {
+            const uint64_t hash = distinct::hash(item);
+            uint64_t result = counters_[column(hash, 0)];
+            for (size_t row = 1; row < Depth; ++row)
+                result = std::min(result, counters_[row * Width + column(hash, row)]);
+            return result;
+        }
+
+        void merge(const CountMinSketch& other) noexcept
+        {
+            for (size_t i = 0; i < counters_.size(); ++i)
+                counters_[i] += other.counters_[i];
+            total_count_ += other.total_count_;
+        }
+
+        uint64_t total_count() const noexcept
+        {
+            return total_count_;
+        }
+
+        static constexpr size_t memory_size() noexcept
+        {
+            return Width * Depth * sizeof(uint64_t);
+        }
+
+    private:
+        // row hashes derived from two halves of a single hash (Kirsch-Mitzenmacher)
+        static size_t column(uint64_t hash, size_t row) noexcept
+        {
+            const uint64_t h1 = hash & 0xffffffff;
+            const uint64_t h2 = (hash >> 32) | 1;
+            return static_cast<size_t>((h1 + row * h2) & (Width - 1));
+        }
+    };
+} // namespace sketches
+
+#endif
@@ -0,0 +1,373 @@
+#ifndef STRING_KERNELS_HPP
+#define STRING_KERNELS_HPP
+
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include <cpu_features.hpp>
+
+#ifdef CPU_HAS_AVX_DISPATCH
+#define STRINGS_NO_SANITIZE __attribute__((no_sanitize_address))
+#else
+#define STRINGS_NO_SANITIZE
+#endif
+
+// string kernels - scalar code in constant evaluation, SIMD code at runtime
+namespace strings
+{
+    constexpr size_t npos = std::string_view::npos;
+
+    namespace scalar
+    {
+        constexpr size_t length(const char* s) noexcept
+        {
+            size_t idx = 0;
+            while (s[idx] != '\0')
+                ++idx;
+            return idx;
+        }
+
+        constexpr size_t find(std::string_view text, char c, size_t pos = 0) noexcept
+        {
+            for (; pos < text.size(); ++pos)
+            {
+                if (text[pos] == c)
+                    return pos;
+            }
+            return npos;
+        }
+
+        constexpr size_t find(std::string_view text, std::string_view pattern, size_t pos = 0) noexcept
+        {
+            if (pattern.size() > text.size())
+                return npos;
+
+            for (; pos <= text.size() - pattern.size(); ++pos)
+            {
+                if (text.substr(pos, pattern.size()) == pattern)
+                    return pos;
+            }
+            return npos;
+        }
+
+        constexpr std::strong_ordering compare(std::string_view a, std::string_view b) noexcept
+        {
+            const size_t common_size = a.size() < b.size() ? a.size() : b.size();
+            for (size_t i = 0; i < common_size; ++i)
+            {
+                if (a[i] != b[i])
+                    return static_cast<unsigned char>(a[i]) <=> static_cast<unsigned char>(b[i]);
+            }
+            return a.size() <=> b.size();
+        }
+
+        constexpr char to_lower(char c) noexcept
+        {
+            return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+        }
+
+        // ASCII only
+        constexpr bool iequals(std::string_view a, std::string_view b) noexcept
+        {
+            if (a.size() != b.size())
+                return false;
+
+            for (size_t i = 0; i < a.size(); ++i)
+            {
+                if (to_lower(a[i]) != to_lower(b[i]))
+                    return false;
+            }
+            return true;
+        }
+    } // namespace scalar
+
+#ifdef CPU_HAS_SSE2
+    namespace sse2
+    {
+        inline __m128i load(const char* ptr) noexcept
+        {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+        }
+
+        inline uint32_t mask_of(__m128i bytes) noexcept
+        {
+            return static_cast<uint32_t>(_mm_movemask_epi8(bytes));
+        }
+
+        // aligned loads never cross a page boundary, so reading past the terminator is safe
+        STRINGS_NO_SANITIZE inline size_t length(const char* s) noexcept
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const char* block = reinterpret_cast<const char*>(reinterpret_cast<uintptr_t>(s) & ~uintptr_t{15});
+
+            uint32_t mask = mask_of(_mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(block)), zero)) >> (s - block);
+            if (mask != 0)
+                return std::countr_zero(mask);
+
+            for (block += 16;; block += 16)
+            {
+                mask = mask_of(_mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(block)), zero));
+                if (mask != 0)
+                    return static_cast<size_t>(block - s) + std::countr_zero(mask);
+            }
+        }
+
+        inline size_t find(std::string_view text, char c, size_t pos) noexcept
+        {
+            const __m128i pattern = _mm_set1_epi8(c);
+            for (; pos < text.size() && text.size() - pos >= 16; pos += 16)
+            {
+                if (uint32_t mask = mask_of(_mm_cmpeq_epi8(load(text.data() + pos), pattern)); mask != 0)
+                    return pos + std::countr_zero(mask);
+            }
+            return scalar::find(text, c, pos);
+        }
+
+        // candidates are positions where both the first and the last character of the pattern match
+        inline size_t find(std::string_view text, std::string_view pattern, size_t pos) noexcept
+        {
+            if (pattern.empty())
+                return pos <= text.size() ? pos : npos;
+            if (pattern.size() > text.size())
+                return npos;
+
+            const size_t last = pattern.size() - 1;
+            const __m128i first_char = _mm_set1_epi8(pattern.front());
+            const __m128i last_char = _mm_set1_epi8(pattern.back());
+
+            for (; pos < text.size() && text.size() - pos >= last + 16; pos += 16)
+            {
+                const __m128i eq_first = _mm_cmpeq_epi8(load(text.data() + pos), first_char);
+                const __m128i eq_last = _mm_cmpeq_epi8(load(text.data() + pos + last), last_char);
+
+                for (uint32_t mask = mask_of(_mm_and_si128(eq_first, eq_last)); mask != 0; mask &= mask - 1)
+                {
+                    const size_t candidate = pos + std::countr_zero(mask);
+                    if (std::memcmp(text.data() + candidate + 1, pattern.data() + 1, last) == 0)
+                        return candidate;
+                }
+            }
+            return scalar::find(text, pattern, pos);
+        }
+
+        inline std::strong_ordering compare(std::string_view a, std::string_view b) noexcept
+        {
+            const size_t common_size = a.size() < b.size() ? a.size() : b.size();
+            size_t pos = 0;
+
+            for (; pos + 16 <= common_size; pos += 16)
+            {
+                const uint32_t mask = mask_of(_mm_cmpeq_epi8(load(a.data() + pos), load(b.data() + pos))) ^ 0xFFFF;
+                if (mask != 0)
+                {
+                    const size_t i = pos + std::countr_zero(mask);
+                    return static_cast<unsigned char>(a[i]) <=> static_cast<unsigned char>(b[i]);
+                }
+            }
+            return scalar::compare(a.substr(pos), b.substr(pos));
+        }
+
+        inline __m128i to_lower(__m128i bytes) noexcept
+        {
+            const __m128i offset = _mm_sub_epi8(bytes, _mm_set1_epi8('A'));
+            const __m128i is_upper = _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8('Z' - 'A')), offset);
+            return _mm_add_epi8(bytes, _mm_and_si128(is_upper, _mm_set1_epi8('a' - 'A')));
+        }
+
+        inline bool iequals(std::string_view a, std::string_view b) noexcept
+        {
+            if (a.size() != b.size())
+                return false;
+
+            size_t pos = 0;
+            for (; pos + 16 <= a.size(); pos += 16)
+            {
+                if (mask_of(_mm_cmpeq_epi8(to_lower(load(a.data() + pos)), to_lower(load(b.data() + pos)))) != 0xFFFF)
+                    return false;
+            }
+            return scalar::iequals(a.substr(pos), b.substr(pos));
+        }
+    } // namespace sse2
+#endif
+
+#ifdef CPU_HAS_AVX_DISPATCH
+    namespace avx2
+    {
+        CPU_TARGET_AVX2 inline __m256i load(const char* ptr) noexcept
+        {
+            return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+        }
+
+        CPU_TARGET_AVX2 inline uint32_t mask_of(__m256i bytes) noexcept
+        {
+            return static_cast<uint32_t>(_mm256_movemask_epi8(bytes));
+        }
+
+        CPU_TARGET_AVX2 STRINGS_NO_SANITIZE inline size_t length(const char* s) noexcept
+        {
+            const __m256i zero = _mm256_setzero_si256();
+            const char* block = reinterpret_cast<const char*>(reinterpret_cast<uintptr_t>(s) & ~uintptr_t{31});
+
+            uint32_t mask = mask_of(_mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(block)), zero)) >> (s - block);
+            if (mask != 0)
+                return std::countr_zero(mask);
+
+            for (block += 32;; block += 32)
+            {
+                mask = mask_of(_mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(block)), zero));
+                if (mask != 0)
+                    return static_cast<size_t>(block - s) + std::countr_zero(mask);
+            }
+        }
+
+        CPU_TARGET_AVX2 inline size_t find(std::string_view text, char c, size_t pos) noexcept
+        {
+            const __m256i pattern = _mm256_set1_epi8(c);
+            for (; pos < text.size() && text.size() - pos >= 32; pos += 32)
+            {
+                if (uint32_t mask = mask_of(_mm256_cmpeq_epi8(load(text.data() + pos), pattern)); mask != 0)
+                    return pos + std::countr_zero(mask);
+            }
+            return sse2::find(text, c, pos);
+        }
+
+        CPU_TARGET_AVX2 inline size_t find(std::string_view text, std::string_view pattern, size_t pos) noexcept
+        {
+            if (pattern.empty())
+                return pos <= text.size() ? pos : npos;
+            if (pattern.size() > text.size())
+                return npos;
+
+            const size_t last = pattern.size() - 1;
+            const __m256i first_char = _mm256_set1_epi8(pattern.front());
+            const __m256i last_char = _mm256_set1_epi8(pattern.back());
+
+            for (; pos < text.size() && text.size() - pos >= last + 32; pos += 32)
+            {
+                const __m256i eq_first = _mm256_cmpeq_epi8(load(text.data() + pos), first_char);
+                const __m256i eq_last = _mm256_cmpeq_epi8(load(text.data() + pos + last), last_char);
+
+                for (uint32_t mask = mask_of(_mm256_and_si256(eq_first, eq_last)); mask != 0; mask &= mask - 1)
+                {
+                    const size_t candidate = pos + std::countr_zero(mask);
+                    if (std::memcmp(text.data() + candidate + 1, pattern.data() + 1, last) == 0)
+                        return candidate;
+                }
+            }
+            return sse2::find(text, pattern, pos);
+        }
+
+        CPU_TARGET_AVX2 inline std::strong_ordering compare(std::string_view a, std::string_view b) noexcept
+        {
+            const size_t common_size = a.size() < b.size() ? a.size() : b.size();
+            size_t pos = 0;
+
+            for (; pos + 32 <= common_size; pos += 32)
+            {
+                const uint32_t mask = ~mask_of(_mm256_cmpeq_epi8(load(a.data() + pos), load(b.data() + pos)));
+                if (mask != 0)
+                {
+                    const size_t i = pos + std::countr_zero(mask);
+                    return static_cast<unsigned char>(a[i]) <=> static_cast<unsigned char>(b[i]);
+                }
+            }
+            return sse2::compare(a.substr(pos), b.substr(pos));
+        }
+
+        CPU_TARGET_AVX2 inline __m256i to_lower(__m256i bytes) noexcept
+        {
+            const __m256i offset = _mm256_sub_epi8(bytes, _mm256_set1_epi8('A'));
+            const __m256i is_upper = _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8('Z' - 'A')), offset);
+            return _mm256_add_epi8(bytes, _mm256_and_si256(is_upper, _mm256_set1_epi8('a' - 'A')));
+        }
+
+        CPU_TARGET_AVX2 inline bool iequals(std::string_view a, std::string_view b) noexcept
+        {
+            if (a.size() != b.size())
+                return false;
+
+            size_t pos = 0;
+            for (; pos + 32 <= a.size(); pos += 32)
+            {
+                if (mask_of(_mm256_cmpeq_epi8(to_lower(load(a.data() + pos)), to_lower(load(b.data() + pos)))) != 0xFFFFFFFF)
+                    return false;
+            }
+            return sse2::iequals(a.substr(pos), b.substr(pos));
+        }
+    } // namespace avx2
+#endif
+
+    constexpr size_t length(const char* s) noexcept
+    {
+        if consteval
+        {
+            return scalar::length(s);
+        }
+        else
+        {
+            return CPU_DISPATCH_AVX2(length, s);
+        }
+    }
+
+    // npos for pos >= text.size() - the kernels never see a position outside of the text
+    constexpr size_t find(std::string_view text, char c, size_t pos = 0) noexcept
+    {
+        if (pos >= text.size())
+            return npos;
+
+        if consteval
+        {
+            return scalar::find(text, c, pos);
+        }
+        else
+        {
+            return CPU_DISPATCH_AVX2(find, text, c, pos);
+        }
+    }
+
+    // npos for pos > text.size() (an empty pattern is found at pos == text.size())
+    constexpr size_t find(std::string_view text, std::string_view pattern, size_t pos = 0) noexcept
+    {
+        if (pos > text.size())
+            return npos;
+
+        if consteval
+        {
+            return scalar::find(text, pattern, pos);
+        }
+        else
+        {
+            return CPU_DISPATCH_AVX2(find, text, pattern, pos);
+        }
+    }
+
+    constexpr std::strong_ordering compare(std::string_view a, std::string_view b) noexcept
+    {
+        if consteval
+        {
+            return scalar::compare(a, b);
+        }
+        else
+        {
+            return CPU_DISPATCH_AVX2(compare, a, b);
+        }
+    }
+
+    constexpr bool iequals(std::string_view a, std::string_view b) noexcept
+    {
+        if consteval
+        {
+            return scalar::iequals(a, b);
+        }
+        else
+        {
+            return CPU_DISPATCH_AVX2(iequals, a, b);
+        }
+    }
+} // namespace strings
+
+#endif
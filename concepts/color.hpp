@@ -0,0 +1,316 @@
+#ifndef COLOR_HPP
+#define COLOR_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include <cpu_features.hpp>
+
+struct Color
+{
+    uint8_t r, g, b;
+};
+
+struct RGBA
+{
+    uint8_t r, g, b, a;
+};
+
+static_assert(sizeof(Color) == 3 && sizeof(RGBA) == 4, "pixels must be tightly packed");
+
+// pixel kernels over packed RGB/RGBA buffers - every SIMD version gives results identical to the scalar one
+namespace colors
+{
+    namespace scalar
+    {
+        // round(x / 255) for x <= 255 * 255
+        constexpr uint32_t div255(uint32_t x) noexcept
+        {
+            x += 128;
+            return (x + (x >> 8)) >> 8;
+        }
+
+        inline void fill(std::span<Color> pixels, Color color) noexcept
+        {
+            for (Color& pixel : pixels)
+                pixel = color;
+        }
+
+        inline void fill(std::span<RGBA> pixels, RGBA color) noexcept
+        {
+            for (RGBA& pixel : pixels)
+                pixel = color;
+        }
+
+        // src over dst with the alpha of src
+        constexpr RGBA blend(RGBA dst, RGBA src) noexcept
+        {
+            const uint32_t a = src.a;
+            const uint32_t inv_a = 255 - a;
+
+            return {static_cast<uint8_t>(div255(src.r * a + dst.r * inv_a)),
+                    static_cast<uint8_t>(div255(src.g * a + dst.g * inv_a)),
+                    static_cast<uint8_t>(div255(src.b * a + dst.b * inv_a)),
+                    static_cast<uint8_t>(div255(a * 255 + dst.a * inv_a))};
+        }
+
+        inline void blend(std::span<RGBA> dst, std::span<const RGBA> src) noexcept
+        {
+            for (size_t i = 0; i < dst.size(); ++i)
+                dst[i] = blend(dst[i], src[i]);
+        }
+
+        inline void convert(std::span<const Color> in, std::span<RGBA> out, uint8_t alpha) noexcept
+        {
+            for (size_t i = 0; i < in.size(); ++i)
+                out[i] = {in[i].r, in[i].g, in[i].b, alpha};
+        }
+
+        inline void convert(std::span<const RGBA> in, std::span<Color> out) noexcept
+        {
+            for (size_t i = 0; i < in.size(); ++i)
+                out[i] = {in[i].r, in[i].g, in[i].b};
+        }
+    } // namespace scalar
+
+#ifdef CPU_HAS_SSE2
+    namespace sse2
+    {
+        inline __m128i broadcast(RGBA color) noexcept
+        {
+            int32_t packed;
+            std::memcpy(&packed, &color, sizeof(packed));
+            return _mm_set1_epi32(packed);
+        }
+
+        inline void fill(std::span<RGBA> pixels, RGBA color) noexcept
+        {
+            const __m128i block = broadcast(color);
+
+            size_t i = 0;
+            for (; i + 4 <= pixels.size(); i += 4)
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels.data() + i), block);
+            scalar::fill(pixels.subspan(i), color);
+        }
+
+        // 16 pixels = 48 bytes = 3 vectors with the repeated 3-byte pattern
+        inline void fill(std::span<Color> pixels, Color color) noexcept
+        {
+            alignas(16) uint8_t pattern[48];
+            for (size_t i = 0; i < 16; ++i)
+                std::memcpy(pattern + 3 * i, &color, sizeof(Color));
+
+            const __m128i v0 = _mm_load_si128(reinterpret_cast<const __m128i*>(pattern));
+            const __m128i v1 = _mm_load_si128(reinterpret_cast<const __m128i*>(pattern + 16));
+            const __m128i v2 = _mm_load_si128(reinterpret_cast<const __m128i*>(pattern + 32));
+
+            size_t i = 0;
+            for (; i + 16 <= pixels.size(); i += 16)
+            {
+                auto* out = reinterpret_cast<uint8_t*>(pixels.data() + i);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), v0);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), v1);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 32), v2);
+            }
+            scalar::fill(pixels.subspan(i), color);
+        }
+
+        // 8 channels (2 pixels) widened to 16 bits
+        inline __m128i blend_half(__m128i src, __m128i dst) noexcept
+        {
+            const __m128i alpha_lanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+            const __m128i max = _mm_set1_epi16(255);
+            const __m128i round = _mm_set1_epi16(128);
+
+            const __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            const __m128i weight = _mm_or_si128(_mm_andnot_si128(alpha_lanes, a), _mm_and_si128(alpha_lanes, max)); // a, a, a, 255
+            const __m128i inv_a = _mm_sub_epi16(max, a);
+
+            __m128i x = _mm_add_epi16(_mm_mullo_epi16(src, weight), _mm_mullo_epi16(dst, inv_a));
+            x = _mm_add_epi16(x, round);
+            return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+        }
+
+        inline void blend(std::span<RGBA> dst, std::span<const RGBA> src) noexcept
+        {
+            const __m128i zero = _mm_setzero_si128();
+
+            size_t i = 0;
+            for (; i + 4 <= dst.size(); i += 4)
+            {
+                const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.data() + i));
+                const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst.data() + i));
+
+                const __m128i low = blend_half(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+                const __m128i high = blend_half(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst.data() + i), _mm_packus_epi16(low, high));
+            }
+            scalar::blend(dst.subspan(i), src.subspan(i));
+        }
+
+        // byte shuffles need SSSE3 - SSE2 converts with scalar code
+        inline void convert(std::span<const Color> in, std::span<RGBA> out, uint8_t alpha) noexcept
+        {
+            scalar::convert(in, out, alpha);
+        }
+
+        inline void convert(std::span<const RGBA> in, std::span<Color> out) noexcept
+        {
+            scalar::convert(in, out);
+        }
+    } // namespace sse2
+#endif
+
+#ifdef CPU_HAS_AVX_DISPATCH
+    namespace avx2
+    {
+        CPU_TARGET_AVX2 inline void fill(std::span<RGBA> pixels, RGBA color) noexcept
+        {
+            int32_t packed;
+            std::memcpy(&packed, &color, sizeof(packed));
+            const __m256i block = _mm256_set1_epi32(packed);
+
+            size_t i = 0;
+            for (; i + 8 <= pixels.size(); i += 8)
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels.data() + i), block);
+            scalar::fill(pixels.subspan(i), color);
+        }
+
+        CPU_TARGET_AVX2 inline void fill(std::span<Color> pixels, Color color) noexcept
+        {
+            alignas(32) uint8_t pattern[96];
+            for (size_t i = 0; i < 32; ++i)
+                std::memcpy(pattern + 3 * i, &color, sizeof(Color));
+
+            const __m256i v0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(pattern));
+            const __m256i v1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(pattern + 32));
+            const __m256i v2 = _mm256_load_si256(reinterpret_cast<const __m256i*>(pattern + 64));
+
+            size_t i = 0;
+            for (; i + 32 <= pixels.size(); i += 32)
+            {
+                auto* out = reinterpret_cast<uint8_t*>(pixels.data() + i);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), v0);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), v1);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 64), v2);
+            }
+            scalar::fill(pixels.subspan(i), color);
+        }
+
+        CPU_TARGET_AVX2 inline __m256i blend_half(__m256i src, __m256i dst) noexcept
+        {
+            const __m256i alpha_lanes = _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0);
+            const __m256i max = _mm256_set1_epi16(255);
+            const __m256i round = _mm256_set1_epi16(128);
+
+            const __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            const __m256i weight = _mm256_blendv_epi8(a, max, alpha_lanes);
+            const __m256i inv_a = _mm256_sub_epi16(max, a);
+
+            __m256i x = _mm256_add_epi16(_mm256_mullo_epi16(src, weight), _mm256_mullo_epi16(dst, inv_a));
+            x = _mm256_add_epi16(x, round);
+            return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+        }
+
+        CPU_TARGET_AVX2 inline void blend(std::span<RGBA> dst, std::span<const RGBA> src) noexcept
+        {
+            const __m256i zero = _mm256_setzero_si256();
+
+            size_t i = 0;
+            for (; i + 8 <= dst.size(); i += 8)
+            {
+                const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src.data() + i));
+                const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst.data() + i));
+
+                // unpack and pack work within 128-bit lanes - the pixel order is preserved
+                const __m256i low = blend_half(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero));
+                const __m256i high = blend_half(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero));
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst.data() + i), _mm256_packus_epi16(low, high));
+            }
+            scalar::blend(dst.subspan(i), src.subspan(i));
+        }
+
+        // 4 pixels per shuffle - a 16-byte load covers 5 1/3 RGB pixels, so the loop stops 6 pixels before the end
+        CPU_TARGET_AVX2 inline void convert(std::span<const Color> in, std::span<RGBA> out, uint8_t alpha) noexcept
+        {
+            const __m128i spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+            const __m128i alpha_bytes = _mm_set1_epi32(static_cast<int32_t>(uint32_t{alpha} << 24));
+
+            size_t i = 0;
+            for (; i + 6 <= in.size(); i += 4)
+            {
+                const __m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in.data() + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out.data() + i), _mm_or_si128(_mm_shuffle_epi8(rgb, spread), alpha_bytes));
+            }
+            scalar::convert(in.subspan(i), out.subspan(i), alpha);
+        }
+
+        // 4 pixels per shuffle - the 16-byte store writes 4 bytes past the converted pixels, so it stops 6 pixels before the end
+        CPU_TARGET_AVX2 inline void convert(std::span<const RGBA> in, std::span<Color> out) noexcept
+        {
+            const __m128i pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+            size_t i = 0;
+            for (; i + 6 <= in.size(); i += 4)
+            {
+                const __m128i rgba = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in.data() + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out.data() + i), _mm_shuffle_epi8(rgba, pack));
+            }
+            scalar::convert(in.subspan(i), out.subspan(i));
+        }
+    } // namespace avx2
+#endif
+
+    inline void fill(std::span<Color> pixels, Color color) noexcept
+    {
+        CPU_DISPATCH_AVX2(fill, pixels, color);
+    }
+
+    inline void fill(std::span<RGBA> pixels, RGBA color) noexcept
+    {
+        CPU_DISPATCH_AVX2(fill, pixels, color);
+    }
+
+    inline void blend(std::span<RGBA> dst, std::span<const RGBA> src) noexcept
+    {
+        assert(dst.size() == src.size());
+        CPU_DISPATCH_AVX2(blend, dst, src);
+    }
+
+    inline void convert(std::span<const Color> in, std::span<RGBA> out, uint8_t alpha = 255) noexcept
+    {
+        assert(in.size() <= out.size());
+        CPU_DISPATCH_AVX2(convert, in, out, alpha);
+    }
+
+    inline void convert(std::span<const RGBA> in, std::span<Color> out) noexcept
+    {
+        assert(in.size() <= out.size());
+        CPU_DISPATCH_AVX2(convert, in, out);
+    }
+
+    // fills the part of the rectangle [x, x + width) x [y, y + height) inside the image
+    template <typename TPixel>
+    void fill_rect(std::span<TPixel> image, size_t image_width, int x, int y, int width, int height, TPixel color) noexcept
+    {
+        if (image_width == 0)
+            return;
+
+        const long long image_height = static_cast<long long>(image.size() / image_width);
+        const long long x0 = std::max(0LL, static_cast<long long>(x));
+        const long long y0 = std::max(0LL, static_cast<long long>(y));
+        const long long x1 = std::min(static_cast<long long>(image_width), static_cast<long long>(x) + width);
+        const long long y1 = std::min(image_height, static_cast<long long>(y) + height);
+
+        for (long long row = y0; row < y1 && x0 < x1; ++row)
+            fill(image.subspan(static_cast<size_t>(row) * image_width + static_cast<size_t>(x0), static_cast<size_t>(x1 - x0)), color);
+    }
+} // namespace colors
+
+#endif
@@ -1,8 +1,15 @@
+#include "color.hpp"
+
 #include <catch2/catch_test_macros.hpp>
+#include <algorithm>
 #include <concepts>
 #include <iostream>
 #include <map>
+#include <random>
+#include <span>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
 using namespace std::literals;
@@ -12,11 +19,6 @@ struct BoundingBox
     int w, h;
 };
 
-struct Color
-{
-    uint8_t r, g, b;
-};
-
 struct Rect
 {
     int w, h;
@@ -92,6 +94,225 @@ TEST_CASE("concept subsumation")
     render(cr);
 }
 
+// painting dispatched on the concepts - colored shapes use their own color
+template <Shape T>
+void paint(std::span<RGBA> image, size_t image_width, int x, int y, const T& shp)
+{
+    const BoundingBox box = shp.box();
+    colors::fill_rect(image, image_width, x, y, box.w, box.h, RGBA{128, 128, 128, 255});
+}
+
+template <ShapeWithColor T>
+void paint(std::span<RGBA> image, size_t image_width, int x, int y, const T& shp)
+{
+    const BoundingBox box = shp.box();
+    const Color color = shp.get_color();
+    colors::fill_rect(image, image_width, x, y, box.w, box.h, RGBA{color.r, color.g, color.b, 255});
+}
+
+TEST_CASE("color kernels")
+{
+    const size_t sizes[] = {0, 1, 3, 7, 8, 15, 16, 17, 31, 33, 64, 100, 1000};
+
+    struct Pixels
+    {
+        std::vector<RGBA> src, dst;
+        std::vector<Color> rgb;
+    };
+
+    std::mt19937 rnd{665};
+    auto random_pixels = [&rnd](size_t size) {
+        auto random_byte = [&rnd] { return static_cast<uint8_t>(rnd()); };
+
+        Pixels pixels{std::vector<RGBA>(size), std::vector<RGBA>(size), std::vector<Color>(size)};
+        for (size_t i = 0; i < size; ++i)
+        {
+            pixels.src[i] = {random_byte(), random_byte(), random_byte(), static_cast<uint8_t>(i % 3 == 0 ? 0 : (i % 3 == 1 ? 255 : random_byte()))};
+            pixels.dst[i] = {random_byte(), random_byte(), random_byte(), random_byte()};
+            pixels.rgb[i] = {random_byte(), random_byte(), random_byte()};
+        }
+        return pixels;
+    };
+
+    auto same_bytes = [](const auto& a, const auto& b) {
+        return std::ranges::equal(std::as_bytes(std::span{a}), std::as_bytes(std::span{b})); // not memcmp - data() of an empty vector may be nullptr
+    };
+
+    SECTION("blend")
+    {
+        for (size_t size : sizes)
+        {
+            INFO("size: " << size);
+            auto [src, dst, rgb] = random_pixels(size);
+
+            std::vector<RGBA> expected = dst;
+            colors::scalar::blend(expected, src);
+#ifdef CPU_HAS_SSE2
+            std::vector<RGBA> sse2_dst = dst;
+            colors::sse2::blend(sse2_dst, src);
+            CHECK(same_bytes(sse2_dst, expected));
+#endif
+#ifdef CPU_HAS_AVX_DISPATCH
+            if (helpers::cpu::has_avx2)
+            {
+                std::vector<RGBA> avx2_dst = dst;
+                colors::avx2::blend(avx2_dst, src);
+                CHECK(same_bytes(avx2_dst, expected));
+            }
+#endif
+            colors::blend(dst, src);
+            CHECK(same_bytes(dst, expected));
+        }
+    }
+
+    SECTION("convert")
+    {
+        for (size_t size : sizes)
+        {
+            INFO("size: " << size);
+            auto [src, dst, rgb] = random_pixels(size);
+
+            std::vector<RGBA> rgba(size), expected_rgba(size);
+            colors::convert(rgb, rgba, 200);
+            colors::scalar::convert(rgb, expected_rgba, 200);
+            CHECK(same_bytes(rgba, expected_rgba));
+
+            std::vector<Color> back(size);
+            colors::convert(rgba, back);
+            CHECK(same_bytes(back, rgb));
+        }
+    }
+
+    SECTION("fill")
+    {
+        for (size_t size : sizes)
+        {
+            INFO("size: " << size);
+            auto [src, dst, rgb] = random_pixels(size);
+
+            std::vector<Color> expected_rgb(size);
+            colors::scalar::fill(expected_rgb, Color{1, 2, 3});
+            std::vector<RGBA> expected_rgba(size);
+            colors::scalar::fill(expected_rgba, RGBA{1, 2, 3, 4});
+
+#ifdef CPU_HAS_SSE2
+            std::vector<Color> sse2_rgb = rgb;
+            colors::sse2::fill(sse2_rgb, Color{1, 2, 3});
+            CHECK(same_bytes(sse2_rgb, expected_rgb));
+
+            std::vector<RGBA> sse2_rgba = dst;
+            colors::sse2::fill(sse2_rgba, RGBA{1, 2, 3, 4});
+            CHECK(same_bytes(sse2_rgba, expected_rgba));
+#endif
+#ifdef CPU_HAS_AVX_DISPATCH
+            if (helpers::cpu::has_avx2)
+            {
+                std::vector<Color> avx2_rgb = rgb;
+                colors::avx2::fill(avx2_rgb, Color{1, 2, 3});
+                CHECK(same_bytes(avx2_rgb, expected_rgb));
+
+                std::vector<RGBA> avx2_rgba = dst;
+                colors::avx2::fill(avx2_rgba, RGBA{1, 2, 3, 4});
+                CHECK(same_bytes(avx2_rgba, expected_rgba));
+            }
+#endif
+            colors::fill(rgb, Color{1, 2, 3});
+            CHECK(same_bytes(rgb, expected_rgb));
+
+            colors::fill(dst, RGBA{1, 2, 3, 4});
+            CHECK(same_bytes(dst, expected_rgba));
+        }
+    }
+
+    static_assert(colors::scalar::blend(RGBA{10, 20, 30, 40}, RGBA{1, 2, 3, 0}).r == 10);
+    static_assert(colors::scalar::blend(RGBA{10, 20, 30, 40}, RGBA{1, 2, 3, 255}).r == 1);
+    static_assert(colors::scalar::blend(RGBA{0, 0, 0, 0}, RGBA{255, 255, 255, 128}).a == 128);
+}
+
+TEST_CASE("painting shapes")
+{
+    const size_t width = 40;
+    std::vector<RGBA> image(width * 30, RGBA{0, 0, 0, 0});
+
+    paint(image, width, 30, 25, Rect{20, 20, {255, 0, 0}}); // clipped at the border
+    paint(image, width, 2, 3, ColorRect{{4, 5, {}}, {0, 255, 0}});
+
+    CHECK(image[25 * width + 30].r == 128);
+    CHECK(image[29 * width + 39].r == 128);
+    CHECK(image[24 * width + 30].a == 0);
+    CHECK(image[3 * width + 2].g == 255);
+    CHECK(image[7 * width + 5].g == 255);
+    CHECK(image[8 * width + 5].a == 0);
+}
+
+// heterogeneous collection - every type is stored in its own contiguous segment, so iteration dispatches statically
+// once per segment (no virtual calls or variant visits per element)
+template <Shape... TShapes>
+class poly_collection
+{
+    std::tuple<std::vector<TShapes>...> segments_;
+
+public:
+    template <typename T>
+        requires(std::same_as<std::remove_cvref_t<T>, TShapes> || ...)
+    void insert(T&& shp)
+    {
+        segment<std::remove_cvref_t<T>>().push_back(std::forward<T>(shp));
+    }
+
+    template <typename T>
+    std::vector<T>& segment()
+    {
+        return std::get<std::vector<T>>(segments_);
+    }
+
+    template <typename T>
+    const std::vector<T>& segment() const
+    {
+        return std::get<std::vector<T>>(segments_);
+    }
+
+    size_t size() const
+    {
+        return std::apply([](const auto&... segment) { return (size_t{0} + ... + segment.size()); }, segments_);
+    }
+
+    // f is instantiated for every segment type - overload resolution picks the most constrained overload once per type
+    template <typename F>
+    void for_each(F f)
+    {
+        std::apply([&f](auto&... segment) { (..., for_each_in(segment, f)); }, segments_);
+    }
+
+private:
+    template <typename T, typename F>
+    static void for_each_in(std::vector<T>& segment, F& f)
+    {
+        for (T& shp : segment)
+            f(shp);
+    }
+};
+
+TEST_CASE("poly_collection")
+{
+    poly_collection<Rect, ColorRect> shapes;
+
+    shapes.insert(Rect{10, 20, {255, 0, 0}});
+    shapes.insert(ColorRect{{1, 2, {0, 0, 0}}, {0, 255, 0}});
+    shapes.insert(Rect{30, 40, {0, 0, 255}});
+
+    REQUIRE(shapes.size() == 3);
+    REQUIRE(shapes.segment<Rect>().size() == 2);
+    REQUIRE(shapes.segment<ColorRect>().size() == 1);
+
+    shapes.for_each([](auto& shp) { render(shp); });
+
+    const Color color = shapes.segment<ColorRect>().front().get_color();
+    CHECK((color.r == 255 && color.g == 255 && color.b == 255)); // render<ShapeWithColor T> selected
+    CHECK(shapes.segment<Rect>().front().color.r == 255);
+    CHECK(shapes.segment<Rect>().back().color.b == 255);
+}
+
 ////////////////////////////////////
 
 template <typename T>
@@ -0,0 +1,43 @@
+#ifndef CPU_FEATURES_HPP
+#define CPU_FEATURES_HPP
+
+// CPU feature detection shared by the SIMD kernels - a kernel library provides scalar::, sse2::, avx2:: and avx512::
+// overloads of a function and selects one of them at runtime with CPU_DISPATCH_AVX2 or CPU_DISPATCH_AVX512
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CPU_HAS_SSE2 1
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#define CPU_HAS_AVX_DISPATCH 1
+#define CPU_TARGET_AVX2 __attribute__((target("avx2")))
+#define CPU_TARGET_AVX512 __attribute__((target("avx512f")))
+
+namespace helpers::cpu
+{
+    inline const bool has_avx2 = __builtin_cpu_supports("avx2");
+    inline const bool has_avx512 = __builtin_cpu_supports("avx512f");
+} // namespace helpers::cpu
+#endif
+
+// avx2:: when supported by the CPU, sse2:: otherwise
+#if defined(CPU_HAS_AVX_DISPATCH)
+#define CPU_DISPATCH_AVX2(function, ...) (::helpers::cpu::has_avx2 ? avx2::function(__VA_ARGS__) : sse2::function(__VA_ARGS__))
+#elif defined(CPU_HAS_SSE2)
+#define CPU_DISPATCH_AVX2(function, ...) sse2::function(__VA_ARGS__)
+#else
+#define CPU_DISPATCH_AVX2(function, ...) scalar::function(__VA_ARGS__)
+#endif
+
+// avx512::, avx2:: or scalar:: - the widest one supported by the CPU
+#if defined(CPU_HAS_AVX_DISPATCH)
+#define CPU_DISPATCH_AVX512(function, ...)                                          \
+    (::helpers::cpu::has_avx512 ? avx512::function(__VA_ARGS__)                     \
+        : ::helpers::cpu::has_avx2 ? avx2::function(__VA_ARGS__) : scalar::function(__VA_ARGS__))
+#else
+#define CPU_DISPATCH_AVX512(function, ...) scalar::function(__VA_ARGS__)
+#endif
+
+#endif
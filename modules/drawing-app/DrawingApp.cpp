@@ -1,5 +1,7 @@
 #include <iostream>
 #include <memory>
+#include <string_view>
+#include <thread>
 
 import Shapes;
 
@@ -17,4 +19,44 @@ int main()
     sq.draw();
     sq.move(50, 20);
     sq.draw();
+
+    Shapes::ConcurrentShapeFactory concurrent_factory;
+    concurrent_factory.register_creator(Shapes::Rectangle::id, [] { return std::make_unique<Shapes::Rectangle>(10, 20, 30, 40); });
+
+    std::jthread worker{[&concurrent_factory] {
+        while (!concurrent_factory.create(std::string_view{"Square"})) // nullptr until the creator is registered
+            std::this_thread::yield();
+        concurrent_factory.create("Rectangle")->draw();
+    }};
+
+    concurrent_factory.register_creator(Shapes::Square::id, [] { return std::make_unique<Shapes::Square>(); });
+
+    static_assert(Shapes::StaticShapeFactory::index_of("Triangle") == Shapes::StaticShapeFactory::size());
+    auto square = Shapes::StaticShapeFactory::create(Shapes::Square::id); // perfect hash computed at compile time
+    square->draw();
+
+    Shapes::PooledShapeFactory pooled_factory;
+    pooled_factory.register_type<Shapes::Square>(Shapes::Square::id);
+    pooled_factory.register_type<Shapes::Rectangle>(Shapes::Rectangle::id);
+
+    auto squares = pooled_factory.create_n(Shapes::Square::id, 100'000); // one slab - no allocation per square
+    for (auto& sq : squares)
+        sq->move(1, 1);
+    squares.back()->draw();
+
+    Shapes::ShapeStore store;
+    store.add(Shapes::Rectangle{10, 20, 100, 50});
+    Shapes::StoredShape stored_square = store.add(sq);
+    store.add_square(-40, -40, 10);
+
+    store.move_all(5, 5);
+    store.move_if([](const Shapes::Bounds& b) { return b.x < 0; }, 100, 0);
+    Shapes::Shape& shape = stored_square; // handle usable wherever a Shape is expected
+    shape.move(-5, -5);
+    store.draw_all();
+
+    Shapes::ShapeStore scene;
+    const auto result = Shapes::parse_scene("Rectangle [0,0] 640 480 # background\nSquare [10,10] 20\nCircle [1,1] 5\n", scene);
+    if (!result)
+        std::cout << "Scene error in line " << result.line << " - " << scene.size() << " shapes loaded\n";
 }
\ No newline at end of file
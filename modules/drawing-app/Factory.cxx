@@ -1,12 +1,26 @@
 module;
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 export module Factory;
 
+import Pool;
+
 export template <typename TProduct, typename TId = std::string, typename TCreator = std::function<std::unique_ptr<TProduct>()>>
 class GenericFactory
 {
@@ -26,4 +40,266 @@ public:
 
         return creator();
     }
-};
\ No newline at end of file
+};
+
+// hash used for the factory ids - string ids can be looked up with std::string_view or const char* keys
+template <typename TId>
+struct IdHash : std::hash<TId>
+{ };
+
+template <>
+struct IdHash<std::string>
+{
+    using is_transparent = void;
+
+    size_t operator()(std::string_view id) const noexcept
+    {
+        return std::hash<std::string_view>{}(id);
+    }
+};
+
+// factory that can be used from many threads while new creators are registered:
+// - create() never waits for register_creator() - it takes a reference to an immutable snapshot of the registry
+// - register_creator() copies the current snapshot, adds the creator and publishes the copy (RCU-style)
+// - a replaced snapshot is released by the last reader that still holds it, so memory does not grow with registrations
+export template <typename TProduct, typename TId = std::string, typename TCreator = std::function<std::unique_ptr<TProduct>()>>
+class ConcurrentFactory
+{
+    using Registry = std::unordered_map<TId, TCreator, IdHash<TId>, std::equal_to<>>;
+
+    std::atomic<std::shared_ptr<const Registry>> registry_{std::make_shared<const Registry>()};
+    std::mutex writers_mtx_;
+
+public:
+    ConcurrentFactory() = default;
+
+    ConcurrentFactory(const ConcurrentFactory&) = delete;
+    ConcurrentFactory& operator=(const ConcurrentFactory&) = delete;
+
+    bool register_creator(TId id, TCreator creator)
+    {
+        std::lock_guard lk{writers_mtx_};
+
+        const std::shared_ptr<const Registry> current = registry_.load(std::memory_order_relaxed);
+        if (current->contains(id))
+            return false;
+
+        auto updated = std::make_shared<Registry>(*current);
+        updated->emplace(std::move(id), std::move(creator));
+
+        registry_.store(std::move(updated), std::memory_order_release);
+
+        return true;
+    }
+
+    // returns nullptr if no creator is registered for the id - the returned pointer keeps its snapshot alive
+    template <typename TKey>
+    std::shared_ptr<const TCreator> find_creator(const TKey& id) const
+    {
+        std::shared_ptr<const Registry> registry = registry_.load(std::memory_order_acquire);
+
+        const auto pos = registry->find(id);
+        if (pos == registry->end())
+            return nullptr;
+
+        return std::shared_ptr<const TCreator>{std::move(registry), &pos->second};
+    }
+
+    // returns nullptr if no creator is registered for the id
+    template <typename TKey>
+    std::unique_ptr<TProduct> create(const TKey& id) const
+    {
+        const std::shared_ptr<const TCreator> creator = find_creator(id);
+
+        return creator ? (*creator)() : nullptr;
+    }
+
+    size_t size() const
+    {
+        return registry_.load(std::memory_order_acquire)->size();
+    }
+};
+
+// string usable as a template argument
+export template <size_t N>
+struct FixedString
+{
+    char text[N];
+
+    constexpr FixedString(const char (&str)[N])
+    {
+        std::copy(str, str + N, text);
+    }
+
+    constexpr std::string_view view() const noexcept
+    {
+        return {text, N - 1};
+    }
+};
+
+// product registered in StaticFactory under an explicit id - types with a static id member can be used directly
+export template <FixedString Id, typename TConcreteProduct>
+struct Named
+{
+    static constexpr std::string_view id = Id.view();
+    using type = TConcreteProduct;
+};
+
+template <typename T>
+struct ProductType
+{
+    using type = T;
+};
+
+template <FixedString Id, typename TConcreteProduct>
+struct ProductType<Named<Id, TConcreteProduct>>
+{
+    using type = TConcreteProduct;
+};
+
+// seeded FNV-1a reduced to the top bits of a multiplicative mix
+constexpr size_t id_hash(std::string_view id, uint64_t seed, unsigned bits) noexcept
+{
+    uint64_t hash = 0xcbf29ce484222325 ^ seed;
+    for (char c : id)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3;
+    }
+    return static_cast<size_t>((hash * 0x9e3779b97f4a7c15) >> (64 - bits));
+}
+
+template <size_t Size>
+struct PerfectHash
+{
+    uint64_t seed;
+    unsigned bits;
+    std::array<uint8_t, 256> slots; // index of the id + 1 (0 - empty slot) - only the first 2^bits are used
+};
+
+// searches for a seed that maps all ids to different slots
+template <size_t Size>
+consteval PerfectHash<Size> make_perfect_hash(const std::array<std::string_view, Size>& ids)
+{
+    static_assert(Size < 128, "too many products for a static factory");
+
+    for (unsigned bits = std::max<unsigned>(std::bit_width(Size), 1); bits <= 8; ++bits)
+    {
+        for (uint64_t seed = 0; seed < 4096; ++seed)
+        {
+            PerfectHash<Size> perfect_hash{seed, bits, {}};
+            bool is_collision_free = true;
+
+            for (size_t i = 0; i < Size && is_collision_free; ++i)
+            {
+                auto& slot = perfect_hash.slots[id_hash(ids[i], seed, bits)];
+                is_collision_free = (slot == 0);
+                slot = static_cast<uint8_t>(i + 1);
+            }
+
+            if (is_collision_free)
+                return perfect_hash;
+        }
+    }
+
+    // not a constant expression - reported as a compilation error (duplicated ids always collide)
+    throw "no collision-free seed found for the set of ids - check that the ids are unique";
+}
+
+// factory for a set of products known at compile time:
+// create(id) - hash of the id, a single comparison and a call through a table indexed by the product's index
+export template <typename TProduct, typename... TProducts>
+class StaticFactory
+{
+    static constexpr std::array<std::string_view, sizeof...(TProducts)> ids_{std::string_view{TProducts::id}...};
+    static constexpr auto perfect_hash_ = make_perfect_hash(ids_);
+
+    using Creator = std::unique_ptr<TProduct> (*)();
+
+    template <typename TConcreteProduct>
+    static std::unique_ptr<TProduct> create_product()
+    {
+        return std::make_unique<TConcreteProduct>();
+    }
+
+    static constexpr std::array<Creator, sizeof...(TProducts)> creators_{&create_product<typename ProductType<TProducts>::type>...};
+
+public:
+    static_assert((std::is_base_of_v<TProduct, typename ProductType<TProducts>::type> && ...));
+
+    static constexpr size_t size() noexcept
+    {
+        return sizeof...(TProducts);
+    }
+
+    // index of the product or size() if the id is unknown
+    static constexpr size_t index_of(std::string_view id) noexcept
+    {
+        const size_t slot = perfect_hash_.slots[id_hash(id, perfect_hash_.seed, perfect_hash_.bits)];
+
+        return (slot != 0 && ids_[slot - 1] == id) ? slot - 1 : size();
+    }
+
+    // returns nullptr if the id is unknown
+    static std::unique_ptr<TProduct> create(std::string_view id)
+    {
+        const size_t index = index_of(id);
+
+        return (index != size()) ? creators_[index]() : nullptr;
+    }
+};
+
+// factory that creates products in per-type slab pools - objects of the same type are allocated contiguously
+// and creation/destruction does not use the global allocator
+// not synchronized - like GenericFactory; the factory must outlive the created objects
+export template <typename TProduct, typename TId = std::string>
+class PooledFactory
+{
+    struct Creator
+    {
+        std::shared_ptr<void> pool;
+        Pool::PooledPtr<TProduct> (*create)(void* pool);
+        void (*reserve)(void* pool, size_t count);
+    };
+
+    std::unordered_map<TId, Creator> creators_;
+
+public:
+    // objects of TConcreteProduct are default constructed
+    template <typename TConcreteProduct>
+        requires std::derived_from<TConcreteProduct, TProduct>
+    bool register_type(TId id, size_t slab_size = Pool::SlabPool<TConcreteProduct>::default_slab_size)
+    {
+        using ProductPool = Pool::SlabPool<TConcreteProduct>;
+
+        Creator creator{
+            std::make_shared<ProductPool>(slab_size),
+            [](void* pool) { return Pool::make_pooled<TProduct>(*static_cast<ProductPool*>(pool)); },
+            [](void* pool, size_t count) { static_cast<ProductPool*>(pool)->reserve(count); }};
+
+        const auto [pos, is_inserted] = creators_.emplace(std::move(id), std::move(creator));
+
+        return is_inserted;
+    }
+
+    Pool::PooledPtr<TProduct> create(const TId& id) const
+    {
+        const Creator& creator = creators_.at(id);
+
+        return creator.create(creator.pool.get());
+    }
+
+    // count objects placed next to each other in memory when the pool has to grow
+    std::vector<Pool::PooledPtr<TProduct>> create_n(const TId& id, size_t count) const
+    {
+        const Creator& creator = creators_.at(id);
+        creator.reserve(creator.pool.get(), count);
+
+        std::vector<Pool::PooledPtr<TProduct>> products;
+        products.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+            products.push_back(creator.create(creator.pool.get()));
+
+        return products;
+    }
+};
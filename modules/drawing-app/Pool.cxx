@@ -0,0 +1,147 @@
+module;
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+export module Pool;
+
+export namespace Pool
+{
+    // pool of objects of a single type allocated in contiguous slabs - freed slots are reused by the next allocations
+    // not synchronized - a pool must be used by one thread at a time
+    template <typename T>
+    class SlabPool
+    {
+        union Slot
+        {
+            Slot* next;
+            alignas(T) std::byte storage[sizeof(T)];
+        };
+
+        std::vector<std::unique_ptr<Slot[]>> slabs_;
+        Slot* free_list_ = nullptr;
+        size_t free_count_ = 0;
+        size_t capacity_ = 0;
+        size_t next_slab_size_;
+
+    public:
+        static constexpr size_t default_slab_size = 256;
+        static constexpr size_t max_slab_size = 1 << 16;
+
+        explicit SlabPool(size_t first_slab_size = default_slab_size)
+            : next_slab_size_{std::max<size_t>(first_slab_size, 1)}
+        { }
+
+        SlabPool(const SlabPool&) = delete;
+        SlabPool& operator=(const SlabPool&) = delete;
+
+        // raw memory for one object
+        T* allocate()
+        {
+            if (free_list_ == nullptr)
+                add_slab(next_slab_size_);
+
+            Slot* slot = std::exchange(free_list_, free_list_->next);
+            --free_count_;
+            return reinterpret_cast<T*>(slot->storage);
+        }
+
+        void deallocate(T* ptr) noexcept
+        {
+            Slot* slot = reinterpret_cast<Slot*>(ptr);
+            slot->next = free_list_;
+            free_list_ = slot;
+            ++free_count_;
+        }
+
+        template <typename... TArgs>
+        T* construct(TArgs&&... args)
+        {
+            T* memory = allocate();
+            try
+            {
+                return std::construct_at(memory, std::forward<TArgs>(args)...);
+            }
+            catch (...)
+            {
+                deallocate(memory);
+                throw;
+            }
+        }
+
+        void destroy(T* ptr) noexcept
+        {
+            std::destroy_at(ptr);
+            deallocate(ptr);
+        }
+
+        // the next count allocations do not allocate - if a new slab is needed they are contiguous
+        void reserve(size_t count)
+        {
+            if (free_count_ < count)
+                add_slab(std::max(count - free_count_, next_slab_size_));
+        }
+
+        size_t capacity() const noexcept
+        {
+            return capacity_;
+        }
+
+        size_t free_count() const noexcept
+        {
+            return free_count_;
+        }
+
+    private:
+        // slots of the new slab are linked in address order in front of the free list
+        void add_slab(size_t size)
+        {
+            auto& slab = slabs_.emplace_back(std::make_unique_for_overwrite<Slot[]>(size));
+
+            for (size_t i = 0; i + 1 < size; ++i)
+                slab[i].next = &slab[i + 1];
+            slab[size - 1].next = free_list_;
+
+            free_list_ = &slab[0];
+            free_count_ += size;
+            capacity_ += size;
+            next_slab_size_ = std::min(next_slab_size_ * 2, max_slab_size); // geometric growth - few slabs for large pools
+        }
+    };
+
+    // returns an object of any type derived from TBase to the pool it was created in
+    template <typename TBase>
+    class PoolDeleter
+    {
+        void* pool_ = nullptr;
+        void (*destroy_)(void* pool, TBase* ptr) noexcept = nullptr;
+
+    public:
+        PoolDeleter() = default;
+
+        template <typename T>
+        explicit PoolDeleter(SlabPool<T>& pool) noexcept
+            : pool_{&pool}
+            , destroy_{[](void* pool, TBase* ptr) noexcept { static_cast<SlabPool<T>*>(pool)->destroy(static_cast<T*>(ptr)); }}
+        { }
+
+        void operator()(TBase* ptr) const noexcept
+        {
+            destroy_(pool_, ptr);
+        }
+    };
+
+    // the pool must outlive all objects created in it
+    template <typename TBase>
+    using PooledPtr = std::unique_ptr<TBase, PoolDeleter<TBase>>;
+
+    template <typename TBase, typename T, typename... TArgs>
+    PooledPtr<TBase> make_pooled(SlabPool<T>& pool, TArgs&&... args)
+    {
+        return PooledPtr<TBase>{pool.construct(std::forward<TArgs>(args)...), PoolDeleter<TBase>{pool}};
+    }
+} // namespace Pool
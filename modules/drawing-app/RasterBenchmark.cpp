@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+
+import Shapes;
+
+// usage: raster_benchmark [shape_count] [output.ppm]
+int main(int argc, char* argv[])
+{
+    const size_t shape_count = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    const int width = 3840;
+    const int height = 2160;
+    const int frame_count = 10;
+
+    std::mt19937 rnd{42};
+    std::uniform_int_distribution<int> x_coordinate{-50, width};
+    std::uniform_int_distribution<int> y_coordinate{-50, height};
+    std::uniform_int_distribution<int> extent{1, 100};
+
+    Shapes::ShapeStore store;
+    for (size_t i = 0; i < shape_count; ++i)
+    {
+        if (i % 2 == 0)
+            store.add_rectangle(x_coordinate(rnd), y_coordinate(rnd), extent(rnd), extent(rnd));
+        else
+            store.add_square(x_coordinate(rnd), y_coordinate(rnd), extent(rnd));
+    }
+
+    Shapes::Framebuffer framebuffer{width, height};
+
+    std::cout << "Shapes: " << shape_count << ", frame: " << width << "x" << height << "\n";
+
+    for (unsigned thread_count : {1u, std::max(std::thread::hardware_concurrency(), 1u)})
+    {
+        Shapes::TiledRasterizer rasterizer{thread_count};
+        rasterizer.render(store, framebuffer); // warm-up - allocates the bins
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frame_count; ++frame)
+        {
+            store.move_all(1, 0);
+            rasterizer.render(store, framebuffer);
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "Threads: " << thread_count << " - " << frame_count / seconds << " fps\n";
+    }
+
+    if (argc > 2 && !framebuffer.write_ppm(argv[2]))
+    {
+        std::cerr << "Cannot write " << argv[2] << "\n";
+        return 1;
+    }
+}
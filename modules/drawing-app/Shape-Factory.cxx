@@ -3,10 +3,18 @@ export module Shapes:Factory;
 import Factory;
 import Singleton;
 import :Base;
+import :Rectangle;
+import :Square;
 
 namespace Shapes
 {
     export using ShapeFactory = GenericFactory<Shape>;
 
     export using SingletonShapeFactory = Singleton::SingletonHolder<ShapeFactory>;
+
+    export using ConcurrentShapeFactory = ConcurrentFactory<Shape>;
+
+    export using PooledShapeFactory = PooledFactory<Shape>;
+
+    export using StaticShapeFactory = StaticFactory<Shape, Rectangle, Square>;
 } // namespace Shapes
\ No newline at end of file
@@ -0,0 +1,266 @@
+module;
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RASTER_HAS_SSE2 1
+#endif
+
+export module Shapes:Raster;
+
+import :Store;
+
+namespace Shapes::RasterDetails
+{
+    void fill_span(uint32_t* pixels, size_t count, uint32_t value) noexcept
+    {
+        size_t i = 0;
+#ifdef RASTER_HAS_SSE2
+        const __m128i block = _mm_set1_epi32(static_cast<int>(value));
+        for (; i + 16 <= count; i += 16)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i), block);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i + 4), block);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i + 8), block);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i + 12), block);
+        }
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i), block);
+#endif
+        for (; i < count; ++i)
+            pixels[i] = value;
+    }
+
+    // filled area [min_x, max_x) x [min_y, max_y) clipped to the framebuffer
+    struct FillCommand
+    {
+        int min_x, min_y, max_x, max_y;
+        uint32_t color;
+    };
+} // namespace Shapes::RasterDetails
+
+export namespace Shapes
+{
+    struct Rgba
+    {
+        uint8_t r = 0;
+        uint8_t g = 0;
+        uint8_t b = 0;
+        uint8_t a = 255;
+
+        // bytes r, g, b, a in memory order
+        constexpr uint32_t packed() const noexcept
+        {
+            return uint32_t{r} | (uint32_t{g} << 8) | (uint32_t{b} << 16) | (uint32_t{a} << 24);
+        }
+
+        static constexpr Rgba unpack(uint32_t pixel) noexcept
+        {
+            return {static_cast<uint8_t>(pixel), static_cast<uint8_t>(pixel >> 8), static_cast<uint8_t>(pixel >> 16), static_cast<uint8_t>(pixel >> 24)};
+        }
+
+        bool operator==(const Rgba&) const = default;
+    };
+
+    class Framebuffer
+    {
+        int width_;
+        int height_;
+        std::vector<uint32_t> pixels_;
+
+    public:
+        Framebuffer(int width, int height)
+            : width_{std::max(width, 0)}
+            , height_{std::max(height, 0)}
+            , pixels_(static_cast<size_t>(width_) * static_cast<size_t>(height_))
+        { }
+
+        int width() const
+        {
+            return width_;
+        }
+
+        int height() const
+        {
+            return height_;
+        }
+
+        std::span<uint32_t> row(int y)
+        {
+            return std::span{pixels_}.subspan(static_cast<size_t>(y) * static_cast<size_t>(width_), static_cast<size_t>(width_));
+        }
+
+        std::span<const uint32_t> row(int y) const
+        {
+            return std::span{pixels_}.subspan(static_cast<size_t>(y) * static_cast<size_t>(width_), static_cast<size_t>(width_));
+        }
+
+        Rgba pixel(int x, int y) const
+        {
+            return Rgba::unpack(row(y)[static_cast<size_t>(x)]);
+        }
+
+        void clear(Rgba color)
+        {
+            RasterDetails::fill_span(pixels_.data(), pixels_.size(), color.packed());
+        }
+
+        // binary PPM (P6) - the alpha channel is dropped; returns false if the file cannot be written
+        bool write_ppm(const std::string& path) const
+        {
+            std::ofstream out{path, std::ios::binary};
+            if (!out)
+                return false;
+
+            out << "P6\n" << width_ << " " << height_ << "\n255\n";
+
+            std::vector<char> line(static_cast<size_t>(width_) * 3);
+            for (int y = 0; y < height_; ++y)
+            {
+                const auto pixels = row(y);
+                for (size_t x = 0; x < pixels.size(); ++x)
+                {
+                    const Rgba color = Rgba::unpack(pixels[x]);
+                    line[3 * x] = static_cast<char>(color.r);
+                    line[3 * x + 1] = static_cast<char>(color.g);
+                    line[3 * x + 2] = static_cast<char>(color.b);
+                }
+                out.write(line.data(), static_cast<std::streamsize>(line.size()));
+            }
+
+            return static_cast<bool>(out);
+        }
+    };
+
+    struct RasterStyle
+    {
+        Rgba background{255, 255, 255};
+        Rgba rectangle{40, 90, 200};
+        Rgba square{220, 60, 40};
+    };
+
+    // draws shapes as filled boxes [x, x + width) x [y, y + height) in store order (later shapes on top):
+    // shapes are binned into tiles that fit in the cache and the tiles are rendered in parallel
+    class TiledRasterizer
+    {
+        unsigned thread_count_;
+        RasterStyle style_;
+
+        // buffers reused between frames
+        std::vector<RasterDetails::FillCommand> commands_;
+        std::vector<uint32_t> bin_offsets_; // commands of tile t: bin_commands_[bin_offsets_[t], bin_offsets_[t + 1])
+        std::vector<uint32_t> bin_commands_;
+
+    public:
+        static constexpr int tile_size = 64; // 16 KiB of pixels per tile
+
+        explicit TiledRasterizer(unsigned thread_count = std::max(std::thread::hardware_concurrency(), 1u), RasterStyle style = {})
+            : thread_count_{std::max(thread_count, 1u)}
+            , style_{style}
+        { }
+
+        void render(const ShapeStore& store, Framebuffer& framebuffer)
+        {
+            const int width = framebuffer.width();
+            const int height = framebuffer.height();
+            const int tiles_x = (width + tile_size - 1) / tile_size;
+            const int tiles_y = (height + tile_size - 1) / tile_size;
+            const size_t tile_count = static_cast<size_t>(tiles_x) * static_cast<size_t>(tiles_y);
+
+            commands_.clear();
+            store.for_each([&](ShapeKind kind, uint32_t, const Bounds& b) {
+                const int64_t min_x = std::max<int64_t>(b.x, 0);
+                const int64_t min_y = std::max<int64_t>(b.y, 0);
+                const int64_t max_x = std::min<int64_t>(int64_t{b.x} + b.width, width);
+                const int64_t max_y = std::min<int64_t>(int64_t{b.y} + b.height, height);
+                if (min_x < max_x && min_y < max_y)
+                {
+                    const Rgba color = (kind == ShapeKind::rectangle) ? style_.rectangle : style_.square;
+                    commands_.push_back({static_cast<int>(min_x), static_cast<int>(min_y), static_cast<int>(max_x), static_cast<int>(max_y), color.packed()});
+                }
+            });
+
+            // binning - counting sort of (tile, command) pairs keeps the commands of every tile in store order
+            bin_offsets_.assign(tile_count + 1, 0);
+            for_each_tile_of_commands(tiles_x, [&](size_t tile, uint32_t) { ++bin_offsets_[tile + 1]; });
+            for (size_t t = 0; t < tile_count; ++t)
+                bin_offsets_[t + 1] += bin_offsets_[t];
+
+            bin_commands_.resize(bin_offsets_[tile_count]);
+            std::vector<uint32_t> positions(bin_offsets_.begin(), bin_offsets_.end() - 1);
+            for_each_tile_of_commands(tiles_x, [&](size_t tile, uint32_t command) { bin_commands_[positions[tile]++] = command; });
+
+            std::atomic<size_t> next_tile{0};
+            auto render_tiles = [&] {
+                for (size_t tile; (tile = next_tile.fetch_add(1, std::memory_order_relaxed)) < tile_count;)
+                    render_tile(framebuffer, static_cast<int>(tile % static_cast<size_t>(tiles_x)), static_cast<int>(tile / static_cast<size_t>(tiles_x)), tile);
+            };
+
+            const unsigned thread_count = static_cast<unsigned>(std::min<size_t>(thread_count_, tile_count));
+            std::vector<std::jthread> workers;
+            for (unsigned t = 1; t < thread_count; ++t)
+                workers.emplace_back(render_tiles);
+            render_tiles();
+        }
+
+    private:
+        template <typename TFunction>
+        void for_each_tile_of_commands(int tiles_x, TFunction f) const
+        {
+            for (uint32_t c = 0; c < commands_.size(); ++c)
+            {
+                const auto& command = commands_[c];
+                for (int ty = command.min_y / tile_size; ty <= (command.max_y - 1) / tile_size; ++ty)
+                    for (int tx = command.min_x / tile_size; tx <= (command.max_x - 1) / tile_size; ++tx)
+                        f(static_cast<size_t>(ty) * static_cast<size_t>(tiles_x) + static_cast<size_t>(tx), c);
+            }
+        }
+
+        void render_tile(Framebuffer& framebuffer, int tile_x, int tile_y, size_t tile) const
+        {
+            const int min_x = tile_x * tile_size;
+            const int min_y = tile_y * tile_size;
+            const int max_x = std::min(min_x + tile_size, framebuffer.width());
+            const int max_y = std::min(min_y + tile_size, framebuffer.height());
+
+            // commands below the last one covering the whole tile are hidden - drawing starts from it
+            uint32_t first = bin_offsets_[tile];
+            for (uint32_t i = bin_offsets_[tile + 1]; i-- > bin_offsets_[tile];)
+            {
+                const auto& command = commands_[bin_commands_[i]];
+                if (command.min_x <= min_x && command.min_y <= min_y && command.max_x >= max_x && command.max_y >= max_y)
+                {
+                    first = i;
+                    break;
+                }
+            }
+
+            if (first == bin_offsets_[tile])
+            {
+                const uint32_t background = style_.background.packed();
+                for (int y = min_y; y < max_y; ++y)
+                    RasterDetails::fill_span(framebuffer.row(y).data() + min_x, static_cast<size_t>(max_x - min_x), background);
+            }
+
+            for (uint32_t i = first; i < bin_offsets_[tile + 1]; ++i)
+            {
+                const auto& command = commands_[bin_commands_[i]];
+                const int x0 = std::max(command.min_x, min_x);
+                const int x1 = std::min(command.max_x, max_x);
+                const int y1 = std::min(command.max_y, max_y);
+
+                for (int y = std::max(command.min_y, min_y); y < y1; ++y)
+                    RasterDetails::fill_span(framebuffer.row(y).data() + x0, static_cast<size_t>(x1 - x0), command.color);
+            }
+        }
+    };
+} // namespace Shapes
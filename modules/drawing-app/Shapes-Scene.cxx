@@ -0,0 +1,353 @@
+module;
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SCENE_HAS_MMAP 1
+#endif
+
+export module Shapes:Scene;
+
+import :Rectangle;
+import :Square;
+import :Store;
+
+namespace Shapes::SceneDetails
+{
+    // read-only contents of a file - memory-mapped where available
+    class MappedFile
+    {
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+        bool is_open_ = false;
+#ifdef SCENE_HAS_MMAP
+        void* mapping_ = nullptr;
+#endif
+        std::vector<char> buffer_;
+
+    public:
+        explicit MappedFile(const std::string& path)
+        {
+#ifdef SCENE_HAS_MMAP
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return;
+
+            struct stat info{};
+            if (::fstat(fd, &info) == 0)
+            {
+                size_ = static_cast<size_t>(info.st_size);
+                is_open_ = true;
+                if (size_ != 0)
+                {
+                    void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (mapping != MAP_FAILED)
+                    {
+                        mapping_ = mapping;
+                        data_ = static_cast<const char*>(mapping);
+                    }
+                    else
+                        is_open_ = false;
+                }
+            }
+            ::close(fd);
+#else
+            std::ifstream in{path, std::ios::binary};
+            if (!in)
+                return;
+
+            buffer_.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+            data_ = buffer_.data();
+            size_ = buffer_.size();
+            is_open_ = true;
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile()
+        {
+#ifdef SCENE_HAS_MMAP
+            if (mapping_)
+                ::munmap(mapping_, size_);
+#endif
+        }
+
+        bool is_open() const
+        {
+            return is_open_;
+        }
+
+        std::string_view contents() const
+        {
+            return {data_, size_};
+        }
+    };
+
+    constexpr char binary_magic[4] = {'S', 'H', 'P', 'S'};
+    constexpr uint32_t binary_version = 1;
+
+    static_assert(sizeof(int) == sizeof(int32_t));
+
+    // binary scene: header followed by the int32 columns of the store (native byte order)
+    struct BinaryHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t rectangle_count;
+        uint64_t square_count;
+    };
+
+    class LineParser
+    {
+        const char* pos_;
+        const char* end_;
+
+    public:
+        explicit LineParser(std::string_view line)
+            : pos_{line.data()}
+            , end_{line.data() + line.size()}
+        { }
+
+        void skip_spaces() noexcept
+        {
+            while (pos_ != end_ && (*pos_ == ' ' || *pos_ == '\t' || *pos_ == '\r'))
+                ++pos_;
+        }
+
+        bool at_end() noexcept
+        {
+            skip_spaces();
+            return pos_ == end_;
+        }
+
+        std::string_view word() noexcept
+        {
+            skip_spaces();
+            const char* first = pos_;
+            while (pos_ != end_ && ((*pos_ >= 'A' && *pos_ <= 'Z') || (*pos_ >= 'a' && *pos_ <= 'z') || *pos_ == '_'))
+                ++pos_;
+            return {first, static_cast<size_t>(pos_ - first)};
+        }
+
+        bool expect(char c) noexcept
+        {
+            skip_spaces();
+            if (pos_ == end_ || *pos_ != c)
+                return false;
+            ++pos_;
+            return true;
+        }
+
+        bool number(int& value) noexcept
+        {
+            skip_spaces();
+            const auto [ptr, ec] = std::from_chars(pos_, end_, value);
+            if (ec != std::errc{})
+                return false;
+            pos_ = ptr;
+            return true;
+        }
+
+        // [x,y] - the Point notation
+        bool point(int& x, int& y) noexcept
+        {
+            return expect('[') && number(x) && expect(',') && number(y) && expect(']');
+        }
+    };
+} // namespace Shapes::SceneDetails
+
+export namespace Shapes
+{
+    enum class SceneError
+    {
+        none,
+        cannot_open,
+        cannot_write,
+        invalid_syntax,
+        unknown_shape,
+        invalid_binary
+    };
+
+    enum class SceneFormat
+    {
+        text,
+        binary
+    };
+
+    // the store is left unchanged if loading fails
+    struct SceneLoadResult
+    {
+        SceneError error = SceneError::none;
+        size_t line = 0; // 1-based line of the error in a text scene
+        size_t shape_count = 0;
+
+        explicit operator bool() const
+        {
+            return error == SceneError::none;
+        }
+    };
+
+    // text scene - one shape per line, # starts a comment:
+    //   Rectangle [x,y] width height
+    //   Square [x,y] size
+    SceneLoadResult parse_scene(std::string_view text, ShapeStore& store)
+    {
+        ShapeStore loaded;
+        const size_t line_estimate = static_cast<size_t>(std::ranges::count(text, '\n')) + 1;
+        loaded.reserve(ShapeKind::rectangle, line_estimate);
+        loaded.reserve(ShapeKind::square, line_estimate);
+
+        size_t line_number = 0;
+        while (!text.empty())
+        {
+            ++line_number;
+
+            const size_t line_end = std::min(text.find('\n'), text.size());
+            std::string_view line = text.substr(0, line_end);
+            text.remove_prefix(std::min(line_end + 1, text.size()));
+
+            line = line.substr(0, std::min(line.find('#'), line.size()));
+
+            SceneDetails::LineParser parser{line};
+            if (parser.at_end())
+                continue;
+
+            const std::string_view kind = parser.word();
+            int x, y, width, height;
+
+            if (kind == Rectangle::id)
+            {
+                if (!parser.point(x, y) || !parser.number(width) || !parser.number(height) || !parser.at_end())
+                    return {SceneError::invalid_syntax, line_number};
+                loaded.add_rectangle(x, y, width, height);
+            }
+            else if (kind == Square::id)
+            {
+                if (!parser.point(x, y) || !parser.number(width) || !parser.at_end())
+                    return {SceneError::invalid_syntax, line_number};
+                loaded.add_square(x, y, width);
+            }
+            else
+                return {SceneError::unknown_shape, line_number};
+        }
+
+        store.append(loaded);
+        return {SceneError::none, 0, loaded.size()};
+    }
+
+    SceneLoadResult parse_binary_scene(std::string_view bytes, ShapeStore& store)
+    {
+        SceneDetails::BinaryHeader header;
+        if (bytes.size() < sizeof(header))
+            return {SceneError::invalid_binary};
+
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (std::memcmp(header.magic, SceneDetails::binary_magic, sizeof(header.magic)) != 0 || header.version != SceneDetails::binary_version)
+            return {SceneError::invalid_binary};
+
+        const uint64_t payload = bytes.size() - sizeof(header);
+        if (header.rectangle_count > payload / (4 * sizeof(int32_t)) || header.square_count > payload / (3 * sizeof(int32_t))
+            || (4 * header.rectangle_count + 3 * header.square_count) * sizeof(int32_t) != payload)
+            return {SceneError::invalid_binary};
+
+        // columns are copied in bulk - the data is not guaranteed to be aligned for int, so it is not used in place
+        std::vector<int> columns(payload / sizeof(int32_t));
+        std::memcpy(columns.data(), bytes.data() + sizeof(header), payload);
+
+        const size_t rectangles = header.rectangle_count;
+        const size_t squares = header.square_count;
+        const std::span<const int> data{columns};
+
+        store.append_rectangles(data.subspan(0, rectangles), data.subspan(rectangles, rectangles),
+                                data.subspan(2 * rectangles, rectangles), data.subspan(3 * rectangles, rectangles));
+        store.append_squares(data.subspan(4 * rectangles, squares), data.subspan(4 * rectangles + squares, squares),
+                             data.subspan(4 * rectangles + 2 * squares, squares));
+
+        return {SceneError::none, 0, rectangles + squares};
+    }
+
+    // appends the shapes of a text or binary scene file (detected by its contents) to the store
+    SceneLoadResult load_scene(const std::string& path, ShapeStore& store)
+    {
+        const SceneDetails::MappedFile file{path};
+        if (!file.is_open())
+            return {SceneError::cannot_open};
+
+        const std::string_view contents = file.contents();
+        if (contents.starts_with(std::string_view{SceneDetails::binary_magic, sizeof(SceneDetails::binary_magic)}))
+            return parse_binary_scene(contents, store);
+
+        return parse_scene(contents, store);
+    }
+
+    SceneError save_scene(const ShapeStore& store, const std::string& path, SceneFormat format = SceneFormat::text)
+    {
+        std::ofstream out{path, std::ios::binary};
+        if (!out)
+            return SceneError::cannot_open;
+
+        const auto& rectangles = store.rectangles();
+        const auto& squares = store.squares();
+
+        if (format == SceneFormat::binary)
+        {
+            SceneDetails::BinaryHeader header{{}, SceneDetails::binary_version, rectangles.x.size(), squares.x.size()};
+            std::memcpy(header.magic, SceneDetails::binary_magic, sizeof(header.magic));
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+            for (const std::vector<int>* column : {&rectangles.x, &rectangles.y, &rectangles.width, &rectangles.height, &squares.x, &squares.y, &squares.size})
+                out.write(reinterpret_cast<const char*>(column->data()), static_cast<std::streamsize>(column->size() * sizeof(int)));
+        }
+        else
+        {
+            std::string text;
+            char number[16];
+            auto append_number = [&](int value, char separator) {
+                text.append(number, std::to_chars(number, number + sizeof(number), value).ptr);
+                text.push_back(separator);
+            };
+
+            for (size_t i = 0; i < rectangles.x.size(); ++i)
+            {
+                text += Rectangle::id;
+                text += " [";
+                append_number(rectangles.x[i], ',');
+                append_number(rectangles.y[i], ']');
+                text.push_back(' ');
+                append_number(rectangles.width[i], ' ');
+                append_number(rectangles.height[i], '\n');
+            }
+
+            for (size_t i = 0; i < squares.x.size(); ++i)
+            {
+                text += Square::id;
+                text += " [";
+                append_number(squares.x[i], ',');
+                append_number(squares.y[i], ']');
+                text.push_back(' ');
+                append_number(squares.size[i], '\n');
+            }
+
+            out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        }
+
+        return out ? SceneError::none : SceneError::cannot_write;
+    }
+} // namespace Shapes
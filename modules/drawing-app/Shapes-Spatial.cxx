@@ -0,0 +1,400 @@
+module;
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+export module Shapes:Spatial;
+
+import :Point;
+import :Rectangle;
+import :Square;
+import :Store;
+
+export namespace Shapes
+{
+    Bounds bounds(const Rectangle& rect)
+    {
+        return {rect.coord().x, rect.coord().y, rect.width(), rect.height()};
+    }
+
+    Bounds bounds(const Square& square)
+    {
+        return {square.coord().x, square.coord().y, square.size(), square.size()};
+    }
+
+    // shape kept in a ShapeStore
+    struct ShapeRef
+    {
+        ShapeKind kind;
+        uint32_t index;
+
+        bool operator==(const ShapeRef&) const = default;
+    };
+
+    // closed box [min_x, max_x] x [min_y, max_y]
+    struct Box
+    {
+        int min_x = std::numeric_limits<int>::max();
+        int min_y = std::numeric_limits<int>::max();
+        int max_x = std::numeric_limits<int>::min();
+        int max_y = std::numeric_limits<int>::min();
+
+        static constexpr Box from(const Bounds& b) noexcept
+        {
+            return {b.x, b.y, b.x + b.width, b.y + b.height};
+        }
+
+        constexpr bool contains(Point pt) const noexcept
+        {
+            return min_x <= pt.x && pt.x <= max_x && min_y <= pt.y && pt.y <= max_y;
+        }
+
+        constexpr bool intersects(const Box& other) const noexcept
+        {
+            return min_x <= other.max_x && other.min_x <= max_x && min_y <= other.max_y && other.min_y <= max_y;
+        }
+
+        constexpr void expand(const Box& other) noexcept
+        {
+            min_x = std::min(min_x, other.min_x);
+            min_y = std::min(min_y, other.min_y);
+            max_x = std::max(max_x, other.max_x);
+            max_y = std::max(max_y, other.max_y);
+        }
+    };
+
+    // static R-tree bulk loaded in Hilbert curve order - all nodes are full and stored level by level in flat arrays;
+    // shapes moved after the build require a rebuild (use UniformGrid for dynamic scenes)
+    class PackedRTree
+    {
+    public:
+        static constexpr size_t node_size = 16;
+
+    private:
+        // position of (x, y) on the Hilbert curve filling the 2^16 x 2^16 square
+        static uint32_t hilbert_index(uint32_t x, uint32_t y) noexcept
+        {
+            uint32_t index = 0;
+            for (uint32_t side = 1 << 15; side > 0; side >>= 1)
+            {
+                const uint32_t rx = (x & side) ? 1 : 0;
+                const uint32_t ry = (y & side) ? 1 : 0;
+                index += side * side * ((3 * rx) ^ ry);
+
+                if (ry == 0) // rotate the quadrant
+                {
+                    if (rx == 1)
+                    {
+                        x = side - 1 - (x & (side - 1));
+                        y = side - 1 - (y & (side - 1));
+                    }
+                    std::swap(x, y);
+                }
+            }
+            return index;
+        }
+
+        std::vector<Box> boxes_;         // items (packed order) followed by the nodes of the upper levels
+        std::vector<ShapeRef> items_;    // shape of the item box at the same position
+        std::vector<size_t> level_ends_; // end position of every level - the last level is the root
+
+        template <typename TBoxPredicate, typename TCallback>
+        void search(TBoxPredicate matches, TCallback callback) const
+        {
+            if (items_.empty() || !matches(boxes_.back()))
+                return;
+
+            struct Entry
+            {
+                size_t position;
+                size_t level;
+            };
+
+            Entry stack[64 * node_size];
+            size_t stack_size = 0;
+            stack[stack_size++] = {boxes_.size() - 1, level_ends_.size() - 1};
+
+            while (stack_size != 0)
+            {
+                const auto [position, level] = stack[--stack_size];
+
+                if (level == 0)
+                {
+                    callback(items_[position]);
+                    continue;
+                }
+
+                const size_t level_begin = level_ends_[level - 1];
+                const size_t children_level_begin = (level == 1) ? 0 : level_ends_[level - 2];
+                const size_t first_child = children_level_begin + (position - level_begin) * node_size;
+                const size_t last_child = std::min(first_child + node_size, level_ends_[level - 1]);
+
+                for (size_t child = first_child; child < last_child; ++child)
+                {
+                    if (matches(boxes_[child]))
+                        stack[stack_size++] = {child, level - 1};
+                }
+            }
+        }
+
+    public:
+        PackedRTree() = default;
+
+        // refs.size() == bounds.size()
+        PackedRTree(std::span<const ShapeRef> refs, std::span<const Bounds> bounds)
+        {
+            assert(refs.size() == bounds.size());
+
+            const size_t count = refs.size();
+            if (count == 0)
+                return;
+
+            Box extent;
+            for (const Bounds& b : bounds)
+                extent.expand(Box::from(b));
+
+            // items sorted along the Hilbert curve through their centers - neighbouring items end up in the same nodes
+            // on every level of the tree
+            const double scale_x = 65535.0 / std::max(1.0, double(extent.max_x) - extent.min_x);
+            const double scale_y = 65535.0 / std::max(1.0, double(extent.max_y) - extent.min_y);
+
+            struct SortKey
+            {
+                uint32_t hilbert;
+                uint32_t index;
+            };
+
+            std::vector<SortKey> order(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                const Box box = Box::from(bounds[i]);
+                const double center_x = (double(box.min_x) + box.max_x) / 2 - extent.min_x;
+                const double center_y = (double(box.min_y) + box.max_y) / 2 - extent.min_y;
+                order[i] = {hilbert_index(static_cast<uint32_t>(center_x * scale_x), static_cast<uint32_t>(center_y * scale_y)),
+                            static_cast<uint32_t>(i)};
+            }
+            std::ranges::sort(order, {}, &SortKey::hilbert);
+
+            boxes_.reserve(count + count / (node_size - 1) + 1);
+            items_.reserve(count);
+            for (const auto [hilbert, i] : order)
+            {
+                boxes_.push_back(Box::from(bounds[i]));
+                items_.push_back(refs[i]);
+            }
+            level_ends_.push_back(count);
+
+            // parent levels group consecutive node_size children
+            for (size_t level_begin = 0, level_end = count; level_end - level_begin > 1;)
+            {
+                for (size_t child = level_begin; child < level_end; child += node_size)
+                {
+                    Box node;
+                    for (size_t i = child; i < std::min(child + node_size, level_end); ++i)
+                        node.expand(boxes_[i]);
+                    boxes_.push_back(node);
+                }
+
+                level_begin = level_end;
+                level_end = boxes_.size();
+                level_ends_.push_back(level_end);
+            }
+        }
+
+        size_t size() const noexcept
+        {
+            return items_.size();
+        }
+
+        template <std::invocable<ShapeRef> TCallback>
+        void query(Point pt, TCallback callback) const
+        {
+            search([pt](const Box& box) { return box.contains(pt); }, callback);
+        }
+
+        template <std::invocable<ShapeRef> TCallback>
+        void query(const Bounds& area, TCallback callback) const
+        {
+            search([box = Box::from(area)](const Box& other) { return box.intersects(other); }, callback);
+        }
+    };
+
+    // uniform grid over a fixed world area for scenes with moving shapes - every shape is kept in all cells it overlaps
+    // (shapes outside of the world are kept in the border cells)
+    class UniformGrid
+    {
+        struct Entry
+        {
+            Box box;
+            ShapeRef ref;
+        };
+
+        Box world_;
+        int cell_size_;
+        int columns_;
+        int rows_;
+        std::vector<std::vector<Entry>> cells_;
+        size_t size_ = 0;
+
+        struct CellRange
+        {
+            int first_column, last_column, first_row, last_row;
+
+            bool operator==(const CellRange&) const = default;
+        };
+
+        int column_of(int x) const noexcept
+        {
+            return std::clamp(static_cast<int>((int64_t{x} - world_.min_x) / cell_size_), 0, columns_ - 1);
+        }
+
+        int row_of(int y) const noexcept
+        {
+            return std::clamp(static_cast<int>((int64_t{y} - world_.min_y) / cell_size_), 0, rows_ - 1);
+        }
+
+        CellRange cells_of(const Box& box) const noexcept
+        {
+            return {column_of(box.min_x), column_of(box.max_x), row_of(box.min_y), row_of(box.max_y)};
+        }
+
+        std::vector<Entry>& cell(int column, int row)
+        {
+            return cells_[static_cast<size_t>(row) * static_cast<size_t>(columns_) + static_cast<size_t>(column)];
+        }
+
+        const std::vector<Entry>& cell(int column, int row) const
+        {
+            return cells_[static_cast<size_t>(row) * static_cast<size_t>(columns_) + static_cast<size_t>(column)];
+        }
+
+        template <typename TFunction>
+        void for_each_cell(const CellRange& range, TFunction f)
+        {
+            for (int row = range.first_row; row <= range.last_row; ++row)
+                for (int column = range.first_column; column <= range.last_column; ++column)
+                    f(cell(column, row));
+        }
+
+    public:
+        UniformGrid(const Bounds& world, int cell_size)
+            : world_{Box::from(world)}
+            , cell_size_{std::max(cell_size, 1)}
+            , columns_{std::max(world.width / cell_size_ + 1, 1)}
+            , rows_{std::max(world.height / cell_size_ + 1, 1)}
+            , cells_(static_cast<size_t>(columns_) * static_cast<size_t>(rows_))
+        { }
+
+        size_t size() const noexcept
+        {
+            return size_;
+        }
+
+        void insert(ShapeRef ref, const Bounds& bounds)
+        {
+            const Box box = Box::from(bounds);
+            for_each_cell(cells_of(box), [&](std::vector<Entry>& entries) { entries.push_back({box, ref}); });
+            ++size_;
+        }
+
+        // bounds must be the bounds used for the insertion (or the last update)
+        void remove(ShapeRef ref, const Bounds& bounds)
+        {
+            for_each_cell(cells_of(Box::from(bounds)), [&](std::vector<Entry>& entries) {
+                const auto pos = std::ranges::find(entries, ref, &Entry::ref);
+                assert(pos != entries.end());
+                *pos = entries.back();
+                entries.pop_back();
+            });
+            --size_;
+        }
+
+        void update(ShapeRef ref, const Bounds& old_bounds, const Bounds& new_bounds)
+        {
+            const Box new_box = Box::from(new_bounds);
+            const CellRange old_cells = cells_of(Box::from(old_bounds));
+            const CellRange new_cells = cells_of(new_box);
+
+            if (old_cells != new_cells)
+            {
+                remove(ref, old_bounds);
+                insert(ref, new_bounds);
+                return;
+            }
+
+            for_each_cell(new_cells, [&](std::vector<Entry>& entries) {
+                std::ranges::find(entries, ref, &Entry::ref)->box = new_box;
+            });
+        }
+
+        // moves the stored shape and updates its cells
+        void move(StoredShape& shape, int dx, int dy)
+        {
+            const Bounds old_bounds = shape.bounds();
+            shape.move(dx, dy);
+            update({shape.kind(), shape.index()}, old_bounds, shape.bounds());
+        }
+
+        template <std::invocable<ShapeRef> TCallback>
+        void query(Point pt, TCallback callback) const
+        {
+            for (const Entry& entry : cell(column_of(pt.x), row_of(pt.y)))
+            {
+                if (entry.box.contains(pt))
+                    callback(entry.ref);
+            }
+        }
+
+        // every intersecting shape is reported once - by the cell containing the corner of the overlap
+        template <std::invocable<ShapeRef> TCallback>
+        void query(const Bounds& area, TCallback callback) const
+        {
+            const Box box = Box::from(area);
+            const CellRange range = cells_of(box);
+
+            for (int row = range.first_row; row <= range.last_row; ++row)
+            {
+                for (int column = range.first_column; column <= range.last_column; ++column)
+                {
+                    for (const Entry& entry : cell(column, row))
+                    {
+                        if (entry.box.intersects(box)
+                            && column_of(std::max(entry.box.min_x, box.min_x)) == column
+                            && row_of(std::max(entry.box.min_y, box.min_y)) == row)
+                            callback(entry.ref);
+                    }
+                }
+            }
+        }
+    };
+
+    // index of all shapes in the store
+    PackedRTree make_rtree(const ShapeStore& store)
+    {
+        std::vector<ShapeRef> refs;
+        std::vector<Bounds> bounds;
+        refs.reserve(store.size());
+        bounds.reserve(store.size());
+
+        store.for_each([&](ShapeKind kind, uint32_t index, const Bounds& b) {
+            refs.push_back({kind, index});
+            bounds.push_back(b);
+        });
+
+        return PackedRTree{refs, bounds};
+    }
+
+    UniformGrid make_grid(const ShapeStore& store, const Bounds& world, int cell_size)
+    {
+        UniformGrid grid{world, cell_size};
+        store.for_each([&](ShapeKind kind, uint32_t index, const Bounds& b) { grid.insert({kind, index}, b); });
+        return grid;
+    }
+} // namespace Shapes
@@ -0,0 +1,294 @@
+module;
+
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+export module Shapes:Store;
+
+import :Base;
+import :Point;
+import :Rectangle;
+import :Square;
+
+export namespace Shapes
+{
+    enum class ShapeKind : uint8_t
+    {
+        rectangle,
+        square
+    };
+
+    // axis-aligned box covered by a shape
+    struct Bounds
+    {
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    class ShapeStore;
+
+    // Shape-compatible reference to a shape kept in a ShapeStore - valid until the store is cleared or destroyed
+    class StoredShape : public Shape
+    {
+        ShapeStore* store_;
+        ShapeKind kind_;
+        uint32_t index_;
+
+    public:
+        StoredShape(ShapeStore& store, ShapeKind kind, uint32_t index)
+            : store_{&store}
+            , kind_{kind}
+            , index_{index}
+        { }
+
+        ShapeKind kind() const
+        {
+            return kind_;
+        }
+
+        uint32_t index() const
+        {
+            return index_;
+        }
+
+        Point coord() const;
+
+        Bounds bounds() const;
+
+        void move(int dx, int dy) override;
+
+        void draw() const override;
+    };
+
+    // struct-of-arrays storage of shapes segregated by kind - batch operations run over plain int columns
+    class ShapeStore
+    {
+    public:
+        struct RectangleColumns
+        {
+            std::vector<int> x, y, width, height;
+        };
+
+        struct SquareColumns
+        {
+            std::vector<int> x, y, size;
+        };
+
+    private:
+        RectangleColumns rectangles_;
+        SquareColumns squares_;
+
+        friend class StoredShape;
+
+        static void draw_shape(ShapeKind kind, const Bounds& b)
+        {
+            if (kind == ShapeKind::rectangle)
+                Rectangle{b.x, b.y, b.width, b.height}.draw();
+            else
+                Square{b.x, b.y, b.width}.draw();
+        }
+
+        static void translate(std::vector<int>& xs, std::vector<int>& ys, int dx, int dy)
+        {
+            int* x = xs.data();
+            int* y = ys.data();
+            for (size_t i = 0, n = xs.size(); i < n; ++i)
+            {
+                x[i] += dx;
+                y[i] += dy;
+            }
+        }
+
+    public:
+        StoredShape add(const Rectangle& rect)
+        {
+            return add_rectangle(rect.coord().x, rect.coord().y, rect.width(), rect.height());
+        }
+
+        StoredShape add(const Square& square)
+        {
+            return add_square(square.coord().x, square.coord().y, square.size());
+        }
+
+        StoredShape add_rectangle(int x, int y, int width, int height)
+        {
+            rectangles_.x.push_back(x);
+            rectangles_.y.push_back(y);
+            rectangles_.width.push_back(width);
+            rectangles_.height.push_back(height);
+
+            return {*this, ShapeKind::rectangle, static_cast<uint32_t>(rectangles_.x.size() - 1)};
+        }
+
+        StoredShape add_square(int x, int y, int size)
+        {
+            squares_.x.push_back(x);
+            squares_.y.push_back(y);
+            squares_.size.push_back(size);
+
+            return {*this, ShapeKind::square, static_cast<uint32_t>(squares_.x.size() - 1)};
+        }
+
+        // bulk insertion of whole columns - all spans must have the same size
+        void append_rectangles(std::span<const int> x, std::span<const int> y, std::span<const int> width, std::span<const int> height)
+        {
+            assert(y.size() == x.size() && width.size() == x.size() && height.size() == x.size());
+
+            rectangles_.x.insert(rectangles_.x.end(), x.begin(), x.end());
+            rectangles_.y.insert(rectangles_.y.end(), y.begin(), y.end());
+            rectangles_.width.insert(rectangles_.width.end(), width.begin(), width.end());
+            rectangles_.height.insert(rectangles_.height.end(), height.begin(), height.end());
+        }
+
+        void append_squares(std::span<const int> x, std::span<const int> y, std::span<const int> size)
+        {
+            assert(y.size() == x.size() && size.size() == x.size());
+
+            squares_.x.insert(squares_.x.end(), x.begin(), x.end());
+            squares_.y.insert(squares_.y.end(), y.begin(), y.end());
+            squares_.size.insert(squares_.size.end(), size.begin(), size.end());
+        }
+
+        void append(const ShapeStore& other)
+        {
+            append_rectangles(other.rectangles_.x, other.rectangles_.y, other.rectangles_.width, other.rectangles_.height);
+            append_squares(other.squares_.x, other.squares_.y, other.squares_.size);
+        }
+
+        const RectangleColumns& rectangles() const
+        {
+            return rectangles_;
+        }
+
+        const SquareColumns& squares() const
+        {
+            return squares_;
+        }
+
+        void reserve(ShapeKind kind, size_t count)
+        {
+            if (kind == ShapeKind::rectangle)
+            {
+                rectangles_.x.reserve(count);
+                rectangles_.y.reserve(count);
+                rectangles_.width.reserve(count);
+                rectangles_.height.reserve(count);
+            }
+            else
+            {
+                squares_.x.reserve(count);
+                squares_.y.reserve(count);
+                squares_.size.reserve(count);
+            }
+        }
+
+        void clear()
+        {
+            rectangles_ = {};
+            squares_ = {};
+        }
+
+        size_t size(ShapeKind kind) const
+        {
+            return (kind == ShapeKind::rectangle) ? rectangles_.x.size() : squares_.x.size();
+        }
+
+        size_t size() const
+        {
+            return rectangles_.x.size() + squares_.x.size();
+        }
+
+        StoredShape operator()(ShapeKind kind, uint32_t index)
+        {
+            assert(index < size(kind));
+            return {*this, kind, index};
+        }
+
+        Bounds bounds(ShapeKind kind, uint32_t index) const
+        {
+            if (kind == ShapeKind::rectangle)
+                return {rectangles_.x[index], rectangles_.y[index], rectangles_.width[index], rectangles_.height[index]};
+
+            return {squares_.x[index], squares_.y[index], squares_.size[index], squares_.size[index]};
+        }
+
+        void move_all(int dx, int dy)
+        {
+            translate(rectangles_.x, rectangles_.y, dx, dy);
+            translate(squares_.x, squares_.y, dx, dy);
+        }
+
+        // moves the shapes whose bounds satisfy the predicate - branch-free, so simple predicates vectorize
+        template <std::predicate<const Bounds&> TPredicate>
+        void move_if(TPredicate pred, int dx, int dy)
+        {
+            for (size_t i = 0, n = rectangles_.x.size(); i < n; ++i)
+            {
+                const int mask = -static_cast<int>(pred(Bounds{rectangles_.x[i], rectangles_.y[i], rectangles_.width[i], rectangles_.height[i]}));
+                rectangles_.x[i] += dx & mask;
+                rectangles_.y[i] += dy & mask;
+            }
+
+            for (size_t i = 0, n = squares_.x.size(); i < n; ++i)
+            {
+                const int mask = -static_cast<int>(pred(Bounds{squares_.x[i], squares_.y[i], squares_.size[i], squares_.size[i]}));
+                squares_.x[i] += dx & mask;
+                squares_.y[i] += dy & mask;
+            }
+        }
+
+        // calls f(kind, index, bounds) for every shape - rectangles first
+        template <std::invocable<ShapeKind, uint32_t, const Bounds&> TFunction>
+        void for_each(TFunction f) const
+        {
+            for (uint32_t i = 0; i < rectangles_.x.size(); ++i)
+                f(ShapeKind::rectangle, i, bounds(ShapeKind::rectangle, i));
+            for (uint32_t i = 0; i < squares_.x.size(); ++i)
+                f(ShapeKind::square, i, bounds(ShapeKind::square, i));
+        }
+
+        void draw_all() const
+        {
+            for_each([](ShapeKind kind, uint32_t, const Bounds& b) { draw_shape(kind, b); });
+        }
+    };
+} // namespace Shapes
+
+namespace Shapes
+{
+    Point StoredShape::coord() const
+    {
+        const Bounds b = bounds();
+        return {b.x, b.y};
+    }
+
+    Bounds StoredShape::bounds() const
+    {
+        return store_->bounds(kind_, index_);
+    }
+
+    void StoredShape::move(int dx, int dy)
+    {
+        if (kind_ == ShapeKind::rectangle)
+        {
+            store_->rectangles_.x[index_] += dx;
+            store_->rectangles_.y[index_] += dy;
+        }
+        else
+        {
+            store_->squares_.x[index_] += dx;
+            store_->squares_.y[index_] += dy;
+        }
+    }
+
+    void StoredShape::draw() const
+    {
+        ShapeStore::draw_shape(kind_, bounds());
+    }
+} // namespace Shapes
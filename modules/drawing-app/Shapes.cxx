@@ -4,4 +4,8 @@ export import :Point;
 export import :Base;
 export import :Factory;
 export import :Rectangle;
-export import :Square;
\ No newline at end of file
+export import :Square;
+export import :Store;
+export import :Spatial;
+export import :Raster;
+export import :Scene;
\ No newline at end of file
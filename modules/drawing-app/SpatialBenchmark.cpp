@@ -0,0 +1,97 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+import Shapes;
+
+namespace
+{
+    template <typename TFunction>
+    double measure_seconds(TFunction f)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+} // namespace
+
+// usage: spatial_benchmark [shape_count]
+int main(int argc, char* argv[])
+{
+    const size_t shape_count = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+    const size_t query_count = 1'000'000;
+    const Shapes::Bounds world{0, 0, 1'000'000, 1'000'000};
+
+    std::mt19937 rnd{42};
+    std::uniform_int_distribution<int> coordinate{world.x, world.x + world.width};
+    std::uniform_int_distribution<int> extent{1, 200};
+
+    Shapes::ShapeStore store;
+    store.reserve(Shapes::ShapeKind::rectangle, shape_count / 2);
+    store.reserve(Shapes::ShapeKind::square, shape_count - shape_count / 2);
+    for (size_t i = 0; i < shape_count; ++i)
+    {
+        if (i % 2 == 0)
+            store.add_rectangle(coordinate(rnd), coordinate(rnd), extent(rnd), extent(rnd));
+        else
+            store.add_square(coordinate(rnd), coordinate(rnd), extent(rnd));
+    }
+
+    std::vector<Shapes::Point> points(query_count);
+    for (auto& pt : points)
+        pt = {coordinate(rnd), coordinate(rnd)};
+
+    std::vector<Shapes::Bounds> areas(query_count / 10);
+    for (auto& area : areas)
+        area = {coordinate(rnd), coordinate(rnd), 1'000, 1'000};
+
+    std::cout << "Shapes: " << shape_count << "\n";
+
+    Shapes::PackedRTree rtree;
+    std::cout << "R-tree build: " << measure_seconds([&] { rtree = Shapes::make_rtree(store); }) << " s\n";
+
+    size_t hits = 0;
+    const double rtree_points = measure_seconds([&] {
+        for (const auto& pt : points)
+            rtree.query(pt, [&](Shapes::ShapeRef) { ++hits; });
+    });
+    std::cout << "R-tree point query: " << rtree_points / query_count * 1e9 << " ns (" << hits << " hits)\n";
+
+    hits = 0;
+    const double rtree_areas = measure_seconds([&] {
+        for (const auto& area : areas)
+            rtree.query(area, [&](Shapes::ShapeRef) { ++hits; });
+    });
+    std::cout << "R-tree range query: " << rtree_areas / areas.size() * 1e9 << " ns (" << hits << " hits)\n";
+
+    Shapes::UniformGrid grid{world, 512};
+    std::cout << "Grid build: " << measure_seconds([&] { grid = Shapes::make_grid(store, world, 512); }) << " s\n";
+
+    hits = 0;
+    const double grid_points = measure_seconds([&] {
+        for (const auto& pt : points)
+            grid.query(pt, [&](Shapes::ShapeRef) { ++hits; });
+    });
+    std::cout << "Grid point query: " << grid_points / query_count * 1e9 << " ns (" << hits << " hits)\n";
+
+    hits = 0;
+    const double grid_areas = measure_seconds([&] {
+        for (const auto& area : areas)
+            grid.query(area, [&](Shapes::ShapeRef) { ++hits; });
+    });
+    std::cout << "Grid range query: " << grid_areas / areas.size() * 1e9 << " ns (" << hits << " hits)\n";
+
+    std::uniform_int_distribution<uint32_t> any_square{0, static_cast<uint32_t>(store.size(Shapes::ShapeKind::square) - 1)};
+    std::uniform_int_distribution<int> step{-100, 100};
+    const double grid_moves = measure_seconds([&] {
+        for (size_t i = 0; i < query_count; ++i)
+        {
+            auto square = store(Shapes::ShapeKind::square, any_square(rnd));
+            grid.move(square, step(rnd), step(rnd));
+        }
+    });
+    std::cout << "Grid move: " << grid_moves / query_count * 1e9 << " ns\n";
+}
@@ -0,0 +1,266 @@
+module;
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+export module Math:BigInteger;
+
+namespace Math::Details
+{
+    using Limb = uint32_t;
+    using Limbs = std::vector<Limb>;
+
+    inline constexpr unsigned limb_bits = 32;
+
+    // below this size (in limbs) the schoolbook multiplication is faster than the Karatsuba recursion
+    inline constexpr size_t karatsuba_threshold = 32;
+
+    constexpr std::span<const Limb> trimmed(std::span<const Limb> limbs) noexcept
+    {
+        while (!limbs.empty() && limbs.back() == 0)
+            limbs = limbs.first(limbs.size() - 1);
+        return limbs;
+    }
+
+    // result += addend - result must be large enough to hold the sum
+    constexpr void add_to(std::span<Limb> result, std::span<const Limb> addend) noexcept
+    {
+        addend = trimmed(addend);
+
+        uint64_t carry = 0;
+        size_t i = 0;
+        for (; i < addend.size(); ++i)
+        {
+            carry += uint64_t{result[i]} + addend[i];
+            result[i] = static_cast<Limb>(carry);
+            carry >>= limb_bits;
+        }
+        for (; carry != 0; ++i)
+        {
+            carry += result[i];
+            result[i] = static_cast<Limb>(carry);
+            carry >>= limb_bits;
+        }
+    }
+
+    // result -= subtrahend - result must not be smaller than subtrahend
+    constexpr void subtract_from(std::span<Limb> result, std::span<const Limb> subtrahend) noexcept
+    {
+        subtrahend = trimmed(subtrahend);
+
+        Limb borrow = 0;
+        size_t i = 0;
+        for (; i < subtrahend.size(); ++i)
+        {
+            const uint64_t difference = uint64_t{result[i]} - subtrahend[i] - borrow;
+            result[i] = static_cast<Limb>(difference);
+            borrow = static_cast<Limb>(difference >> 63);
+        }
+        for (; borrow != 0; ++i)
+        {
+            borrow = (result[i] == 0);
+            --result[i];
+        }
+    }
+
+    // result (zeroed, size a.size() + b.size()) = a * b
+    constexpr void multiply_schoolbook(std::span<Limb> result, std::span<const Limb> a, std::span<const Limb> b) noexcept
+    {
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < b.size(); ++j)
+            {
+                carry += uint64_t{a[i]} * b[j] + result[i + j];
+                result[i + j] = static_cast<Limb>(carry);
+                carry >>= limb_bits;
+            }
+            result[i + b.size()] = static_cast<Limb>(carry);
+        }
+    }
+
+    // result (zeroed, size a.size() + b.size()) = a * b
+    // a = a1 * B^h + a0, b = b1 * B^h + b0:
+    // a * b = a1 * b1 * B^2h + ((a0 + a1) * (b0 + b1) - a0 * b0 - a1 * b1) * B^h + a0 * b0 - three half-size products
+    constexpr void multiply_karatsuba(std::span<Limb> result, std::span<const Limb> a, std::span<const Limb> b)
+    {
+        if (a.size() < b.size())
+            std::swap(a, b);
+
+        if (b.size() < karatsuba_threshold)
+        {
+            multiply_schoolbook(result, a, b);
+            return;
+        }
+
+        const size_t half = (a.size() + 1) / 2;
+
+        if (b.size() <= half) // unbalanced - multiply both halves of a by the whole b
+        {
+            multiply_karatsuba(result.first(half + b.size()), a.first(half), b);
+
+            Limbs high_product(a.size() - half + b.size());
+            multiply_karatsuba(high_product, a.subspan(half), b);
+            add_to(result.subspan(half), high_product);
+            return;
+        }
+
+        const auto a0 = a.first(half), a1 = a.subspan(half);
+        const auto b0 = b.first(half), b1 = b.subspan(half);
+
+        const auto low = result.first(2 * half);
+        const auto high = result.subspan(2 * half);
+        multiply_karatsuba(low, a0, b0);
+        multiply_karatsuba(high, a1, b1);
+
+        Limbs a_sum(half + 1);
+        std::ranges::copy(a0, a_sum.begin());
+        add_to(a_sum, a1);
+
+        Limbs b_sum(half + 1);
+        std::ranges::copy(b0, b_sum.begin());
+        add_to(b_sum, b1);
+
+        Limbs middle(2 * half + 2);
+        multiply_karatsuba(middle, a_sum, b_sum);
+        subtract_from(middle, low);
+        subtract_from(middle, high);
+
+        add_to(result.subspan(half), middle);
+    }
+} // namespace Math::Details
+
+namespace Math
+{
+    // arbitrary-precision non-negative integer - little-endian 32-bit limbs without leading zero limbs
+    export class BigInteger
+    {
+        Details::Limbs limbs_;
+
+        constexpr void normalize() noexcept
+        {
+            while (!limbs_.empty() && limbs_.back() == 0)
+                limbs_.pop_back();
+        }
+
+    public:
+        constexpr BigInteger() = default;
+
+        constexpr BigInteger(uint64_t value)
+        {
+            for (; value != 0; value >>= Details::limb_bits)
+                limbs_.push_back(static_cast<Details::Limb>(value));
+        }
+
+        constexpr bool is_zero() const noexcept
+        {
+            return limbs_.empty();
+        }
+
+        constexpr std::span<const uint32_t> limbs() const noexcept
+        {
+            return limbs_;
+        }
+
+        constexpr uint64_t bit_width() const noexcept
+        {
+            return limbs_.empty() ? 0 : (limbs_.size() - 1) * Details::limb_bits + std::bit_width(limbs_.back());
+        }
+
+        constexpr BigInteger& operator+=(const BigInteger& other)
+        {
+            limbs_.resize(std::max(limbs_.size(), other.limbs_.size()) + 1);
+            Details::add_to(limbs_, other.limbs_);
+            normalize();
+            return *this;
+        }
+
+        // precondition: *this >= other
+        constexpr BigInteger& operator-=(const BigInteger& other)
+        {
+            Details::subtract_from(limbs_, other.limbs_);
+            normalize();
+            return *this;
+        }
+
+        constexpr friend BigInteger operator+(BigInteger a, const BigInteger& b)
+        {
+            return a += b;
+        }
+
+        constexpr friend BigInteger operator-(BigInteger a, const BigInteger& b)
+        {
+            return a -= b;
+        }
+
+        constexpr friend BigInteger operator*(const BigInteger& a, const BigInteger& b)
+        {
+            BigInteger product;
+            if (a.is_zero() || b.is_zero())
+                return product;
+
+            product.limbs_.resize(a.limbs_.size() + b.limbs_.size());
+            Details::multiply_karatsuba(product.limbs_, a.limbs_, b.limbs_);
+            product.normalize();
+            return product;
+        }
+
+        constexpr BigInteger& operator*=(const BigInteger& other)
+        {
+            return *this = *this * other;
+        }
+
+        constexpr friend bool operator==(const BigInteger& a, const BigInteger& b) = default;
+
+        constexpr friend std::strong_ordering operator<=>(const BigInteger& a, const BigInteger& b) noexcept
+        {
+            if (a.limbs_.size() != b.limbs_.size())
+                return a.limbs_.size() <=> b.limbs_.size();
+
+            return std::lexicographical_compare_three_way(a.limbs_.rbegin(), a.limbs_.rend(), b.limbs_.rbegin(), b.limbs_.rend());
+        }
+
+        // decimal representation - quadratic in the number of limbs
+        constexpr std::string to_string() const
+        {
+            if (is_zero())
+                return "0";
+
+            constexpr Details::Limb chunk_base = 1'000'000'000; // 9 decimal digits per division pass
+
+            Details::Limbs quotient = limbs_;
+            std::string digits;
+            while (!quotient.empty())
+            {
+                uint64_t remainder = 0;
+                for (size_t i = quotient.size(); i-- > 0;)
+                {
+                    const uint64_t current = (remainder << Details::limb_bits) | quotient[i];
+                    quotient[i] = static_cast<Details::Limb>(current / chunk_base);
+                    remainder = current % chunk_base;
+                }
+
+                while (!quotient.empty() && quotient.back() == 0)
+                    quotient.pop_back();
+
+                for (int i = 0; i < 9 && (remainder != 0 || !quotient.empty()); ++i, remainder /= 10)
+                    digits.push_back(static_cast<char>('0' + remainder % 10));
+            }
+
+            std::ranges::reverse(digits);
+            return digits;
+        }
+
+        friend std::ostream& operator<<(std::ostream& out, const BigInteger& value)
+        {
+            return out << value.to_string();
+        }
+    };
+} // namespace Math
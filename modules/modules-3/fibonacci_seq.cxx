@@ -2,33 +2,116 @@ module;
 
 #include <cstdint>
 #include <array>
+#include <bit>
+#include <concepts>
+#include <type_traits>
+#include <utility>
 
 export module Math:Fibonacci;
 
-export namespace Math::Fibonacci // all declarations in this namespace are exported
+import :BigInteger;
+
+namespace Math::Fibonacci::Details
 {
-    constexpr uint32_t fibonacci(uint32_t n)
+    // F(n) with fast doubling - O(log n) steps:
+    // F(2k) = F(k) * (2 * F(k + 1) - F(k)), F(2k + 1) = F(k)^2 + F(k + 1)^2
+    template <typename T, typename TAdd, typename TSubtract, typename TMultiply>
+    constexpr T fast_doubling(uint64_t n, TAdd add, TSubtract subtract, TMultiply multiply)
+    {
+        if (n == 0)
+            return T{0};
+
+        T current{0}; // F(k)
+        T next{1};    // F(k + 1)
+
+        for (int bit = std::bit_width(n) - 1; bit > 0; --bit)
+        {
+            T doubled = multiply(current, subtract(add(next, next), current));
+            T doubled_next = add(multiply(current, current), multiply(next, next));
+
+            if ((n >> bit) & 1)
+            {
+                current = std::move(doubled_next);
+                next = add(doubled, current);
+            }
+            else
+            {
+                current = std::move(doubled);
+                next = std::move(doubled_next);
+            }
+        }
+
+        // the last step needs only one of the pair
+        if (n & 1)
+            return add(multiply(current, current), multiply(next, next));
+        return multiply(current, subtract(add(next, next), current));
+    }
+
+    constexpr uint64_t multiply_mod(uint64_t a, uint64_t b, uint64_t modulus) noexcept
     {
-        if (n <= 1)
+#ifdef __SIZEOF_INT128__
+        return static_cast<uint64_t>(static_cast<unsigned __int128>(a) * b % modulus);
+#else
+        uint64_t result = 0;
+        for (a %= modulus; b != 0; b >>= 1)
         {
-            return n;
+            if (b & 1)
+                result = (result >= modulus - a) ? result - (modulus - a) : result + a;
+            a = (a >= modulus - a) ? a - (modulus - a) : a + a;
         }
+        return result;
+#endif
+    }
+} // namespace Math::Fibonacci::Details
 
-        return fibonacci(n - 1) + fibonacci(n - 2);
+export namespace Math::Fibonacci // all declarations in this namespace are exported
+{
+    // F(n) modulo 2^bits of T
+    template <std::unsigned_integral T = uint32_t>
+    constexpr T fibonacci(uint64_t n)
+    {
+        return Details::fast_doubling<T>(
+            n,
+            [](T a, T b) -> T { return a + b; },
+            [](T a, T b) -> T { return a - b; },
+            [](T a, T b) -> T { return static_cast<std::common_type_t<T, unsigned>>(a) * b; }); // no signed overflow for small T
     }
 
-    template <uint32_t N>
-    constexpr std::array<uint32_t, N> get_fibonacci_sequence()
+    // F(n) mod modulus - any modulus in [1, 2^64)
+    constexpr uint64_t fibonacci_mod(uint64_t n, uint64_t modulus)
     {
-        std::array<uint32_t, N> fibonaccis{};
+        return Details::fast_doubling<uint64_t>(
+            n,
+            [=](uint64_t a, uint64_t b) { return (a >= modulus - b) ? a - (modulus - b) : a + b; },
+            [=](uint64_t a, uint64_t b) { return (a >= b) ? a - b : a + (modulus - b); },
+            [=](uint64_t a, uint64_t b) { return Details::multiply_mod(a, b, modulus); }) % modulus;
+    }
+
+    // exact F(n) - products of the large values use Karatsuba multiplication
+    constexpr BigInteger big_fibonacci(uint64_t n)
+    {
+        return Details::fast_doubling<BigInteger>(
+            n,
+            [](const BigInteger& a, const BigInteger& b) { return a + b; },
+            [](const BigInteger& a, const BigInteger& b) { return a - b; },
+            [](const BigInteger& a, const BigInteger& b) { return a * b; });
+    }
+
+    // F(0), ..., F(N - 1) - O(N)
+    template <uint32_t N, std::unsigned_integral T = uint32_t>
+    constexpr std::array<T, N> get_fibonacci_sequence()
+    {
+        std::array<T, N> fibonaccis{};
 
         for (uint32_t i = 0; i < N; ++i)
         {
-            fibonaccis[i] = fibonacci(i);
+            fibonaccis[i] = (i <= 1) ? T(i) : T(fibonaccis[i - 1] + fibonaccis[i - 2]);
         }
 
         return fibonaccis;
     }
 
     constexpr std::array fibonacci_lookup_table = get_fibonacci_sequence<20>();
-}
\ No newline at end of file
+
+    constexpr std::array fibonacci_lookup_table_64 = get_fibonacci_sequence<94, uint64_t>(); // F(93) is the largest 64-bit one
+}
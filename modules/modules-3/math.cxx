@@ -1,4 +1,6 @@
 export module Math;
 
 export import :Primes;
+export import :PrimeCount;
+export import :BigInteger;
 export import :Fibonacci;
\ No newline at end of file
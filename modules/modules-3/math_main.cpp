@@ -1,12 +1,76 @@
 #include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <iterator>
 #include <ranges>
+#include <utility>
 
 import Math; // importing module Math
 
+// prime_pi compared with the sieve for every x <= 10^5, on both sides of the bound where the tiers get long enough
+// to be split between threads (sqrt(x) ~ 2^17) and with known values
+bool prime_pi_matches_sieve()
+{
+    using Math::Primes::prime_pi, Math::Primes::count_primes_below, Math::Primes::primes_below;
+
+    // count_primes_below(x + 1) for every x - a running count over one sieve
+    const auto primes = primes_below(100'001);
+    uint64_t count = 0;
+    for (uint64_t x = 0; x <= 100'000; ++x)
+    {
+        if (count < primes.size() && primes[count] == x)
+            ++count;
+
+        if (prime_pi(x, 1) != count || (x % 9'973 == 0 && count_primes_below(x + 1) != count))
+        {
+            std::cout << "prime_pi(" << x << ") != count_primes_below(" << x + 1 << ")\n";
+            return false;
+        }
+    }
+
+    for (uint64_t x : {(uint64_t{1} << 34) - 1, uint64_t{1} << 34, (uint64_t{1} << 34) + 1})
+    {
+        if (prime_pi(x, 1) != prime_pi(x, 8))
+        {
+            std::cout << "prime_pi(" << x << ") - single-threaded and multithreaded results differ\n";
+            return false;
+        }
+    }
+
+    const std::pair<uint64_t, uint64_t> known_values[] = {{uint64_t{1} << 32, 203'280'221},
+                                                          {10'000'000'000, 455'052'511},
+                                                          {100'000'000'000, 4'118'054'813},
+                                                          {1'000'000'000'000, 37'607'912'018}};
+    for (const auto& [x, expected] : known_values)
+    {
+        if (prime_pi(x) != expected)
+        {
+            std::cout << "prime_pi(" << x << ") != " << expected << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
 int main()
 {
+    if (!prime_pi_matches_sieve())
+        return EXIT_FAILURE;
+
     std::cout << "check if 13 is prime: " << Math::Primes::is_prime(13) << "\n";
+
+    static_assert(Math::Primes::is_prime(18'446'744'073'709'551'557ull)); // the largest 64-bit prime
+    static_assert(!Math::Primes::is_prime(3'215'031'751u));                // strong pseudoprime to bases 2, 3, 5 and 7
+
+    const uint64_t candidates[] = {1'000'000'007, 1'000'000'011, 4'294'967'297, 999'999'999'989};
+    bool results[std::size(candidates)];
+    Math::Primes::is_prime(candidates, results);
+
+    std::cout << "Batch primality test: ";
+    for (size_t i = 0; i < std::size(candidates); ++i)
+        std::cout << candidates[i] << (results[i] ? " - prime; " : " - composite; ");
+    std::cout << "\n";
     // std::cout << "check if 42 is prime: " << IsPrime{}(42) << "\n";
 
     using Math::Primes::get_primes, Math::Primes::first_primes;
@@ -29,8 +93,30 @@ int main()
         std::cout << n << " ";
     std::cout << "\n";
 
+    constexpr auto large_prime_table = get_primes<10'000>(); // computed at compile time with a segmented sieve
+    static_assert(large_prime_table.back() == 104'729);
+    std::cout << "10000th prime: " << large_prime_table.back() << "\n";
+
+    std::cout << "Primes below 10^9: " << Math::Primes::count_primes_below(1'000'000'000) << "\n";
+
+    const auto primes_below_million = Math::Primes::primes_below(1'000'000);
+    std::cout << "Largest prime below 10^6: " << primes_below_million.back() << "\n";
+
+    static_assert(Math::Primes::prime_pi(1'000'000) == 78'498);
+    std::cout << "pi(10^12): " << Math::Primes::prime_pi(1'000'000'000'000) << "\n"; // sublinear - no sieving up to 10^12
+
+    std::cout << "Primes after 10^12: ";
+    for (uint64_t p : Math::Primes::primes_view(1'000'000'000'000, 1'000'000'001'000) | std::views::take(3))
+        std::cout << p << " ";
+    std::cout << "\n";
+
     std::cout << "Fibonacci lookup table: ";
     for(const auto& fib : Math::Fibonacci::fibonacci_lookup_table | std::views::take(15))
         std::cout << fib << " ";
     std::cout << "...\n";
+
+    static_assert(Math::Fibonacci::fibonacci<uint64_t>(93) == Math::Fibonacci::fibonacci_lookup_table_64.back());
+    std::cout << "F(10^18) mod 10^9+7: " << Math::Fibonacci::fibonacci_mod(1'000'000'000'000'000'000, 1'000'000'007) << "\n";
+    std::cout << "F(500): " << Math::Fibonacci::big_fibonacci(500) << "\n";
+    std::cout << "F(10^6) has " << Math::Fibonacci::big_fibonacci(1'000'000).bit_width() << " bits\n";
 }
\ No newline at end of file
@@ -0,0 +1,182 @@
+module;
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+export module Math:PrimeCount;
+
+import :Primes;
+
+namespace Math::Primes
+{
+    // floor(n / d) for n < 2^52 - a multiplication by the reciprocal instead of an integer division
+    class Divider
+    {
+        uint64_t d_;
+        double inverse_;
+
+    public:
+        constexpr explicit Divider(uint64_t d)
+            : d_{d}
+            , inverse_{1.0 / static_cast<double>(d)}
+        { }
+
+        constexpr uint64_t divide(uint64_t n) const noexcept
+        {
+            auto q = static_cast<uint64_t>(static_cast<double>(n) * inverse_); // off by at most one
+            if (q * d_ > n)
+                --q;
+            else if ((q + 1) * d_ <= n)
+                ++q;
+            return q;
+        }
+    };
+
+    inline constexpr uint64_t max_fast_division = uint64_t{1} << 52;
+
+    // floor(n / d) for n < 2^52 - floating point division is much faster than a 64-bit integer division
+    constexpr uint64_t fast_divide(uint64_t n, uint64_t d) noexcept
+    {
+        auto q = static_cast<uint64_t>(static_cast<double>(n) / static_cast<double>(d));
+        if (q * d > n)
+            --q;
+        else if ((q + 1) * d <= n)
+            ++q;
+        return q;
+    }
+
+    // x / i for x just below the bound where prime_pi switches back to integer division
+    static_assert([] {
+        for (uint64_t n = max_fast_division - 64; n < max_fast_division; ++n)
+        {
+            for (uint64_t d : {uint64_t{2}, uint64_t{3}, uint64_t{7}, uint64_t{1'000'003}, (uint64_t{1} << 26) - 1, uint64_t{1} << 26})
+            {
+                if (fast_divide(n, d) != n / d)
+                    return false;
+            }
+        }
+        return true;
+    }());
+
+    constexpr uint64_t constexpr_sqrt(uint64_t n)
+    {
+        uint64_t root = 0;
+        for (uint64_t bit = uint64_t{1} << 31; bit != 0; bit >>= 1)
+        {
+            if ((root + bit) * (root + bit) <= n)
+                root += bit;
+        }
+        return root;
+    }
+
+    // calls f(first, last) for ranges of indexes - the ranges are processed in parallel when there are many indexes
+    template <typename TFunction>
+    constexpr void parallel_for(uint64_t first, uint64_t last, unsigned thread_count, TFunction f)
+    {
+        constexpr uint64_t min_items_per_thread = 1 << 15;
+
+        const uint64_t size = last - first;
+        thread_count = static_cast<unsigned>(std::clamp<uint64_t>(size / min_items_per_thread, 1, thread_count));
+
+        if (std::is_constant_evaluated() || thread_count == 1)
+        {
+            f(first, last);
+            return;
+        }
+
+        std::vector<std::jthread> workers;
+        for (unsigned t = 1; t < thread_count; ++t)
+            workers.emplace_back([=] { f(first + size * t / thread_count, first + size * (t + 1) / thread_count); });
+
+        f(first, first + size / thread_count);
+    }
+
+    // number of primes <= x - Lucy_Hedgehog's algorithm: O(x^(3/4)) time, O(sqrt(x)) memory
+    //
+    // S(v) - number of primes <= v after sieving by primes < p - is kept for all values v = x / i:
+    // large[i] = S(x / i) for i <= sqrt(x) and small[v] = S(v) for v <= x / sqrt(x)
+    // for every prime p: S(v) -= S(v / p) - S(p - 1) for v >= p^2
+    // thread_count == 0 - all hardware threads
+    export constexpr uint64_t prime_pi(uint64_t x, unsigned thread_count = 0)
+    {
+        if (x < 2)
+            return 0;
+
+        if (std::is_constant_evaluated())
+            thread_count = 1;
+        else if (thread_count == 0)
+            thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+
+        const uint64_t r = constexpr_sqrt(x);
+        const uint64_t m = x / r;
+        const bool fast_division = x < max_fast_division;
+
+        std::vector<uint64_t> large(r + 1);
+        std::vector<uint64_t> small(m + 1);
+
+        for (uint64_t i = 1; i <= r; ++i)
+            large[i] = x / i - 1;
+        for (uint64_t v = 1; v <= m; ++v)
+            small[v] = v - 1;
+
+        for (uint64_t p = 2; p <= r; ++p)
+        {
+            if (small[p] == small[p - 1]) // p is not a prime
+                continue;
+
+            const uint64_t primes_below_p = small[p - 1];
+            const uint64_t p_squared = p * p;
+            const uint64_t large_end = std::min(r, x / p_squared);
+            const Divider by_p{p};
+
+            // large[i] reads large[i * p] that is updated in this round only if i * p <= large_end
+            // - indexes are split into tiers (large_end / p^(k + 1), large_end / p^k] processed in ascending order,
+            //   so every tier reads only old values from the higher tiers
+            std::vector<uint64_t> tier_bounds{large_end};
+            while (tier_bounds.back() != 0)
+                tier_bounds.push_back(tier_bounds.back() / p);
+
+            for (size_t tier = tier_bounds.size() - 1; tier > 0; --tier)
+            {
+                parallel_for(tier_bounds[tier] + 1, tier_bounds[tier - 1] + 1, thread_count, [&](uint64_t first, uint64_t last) {
+                    for (uint64_t i = first; i < last; ++i)
+                    {
+                        const uint64_t ip = i * p;
+                        uint64_t s;
+                        if (ip <= r)
+                            s = large[ip];
+                        else
+                            s = small[fast_division ? fast_divide(x, ip) : x / ip];
+                        large[i] -= s - primes_below_p;
+                    }
+                });
+            }
+
+            // small[v] reads small[v / p] that must be updated later - tiers [p^k, p^(k + 1)) in descending order
+            if (p_squared <= m)
+            {
+                uint64_t tier_begin = p_squared;
+                std::vector<uint64_t> small_tiers{tier_begin};
+                while (tier_begin <= m / p)
+                {
+                    tier_begin *= p;
+                    small_tiers.push_back(tier_begin);
+                }
+                small_tiers.push_back(m + 1);
+
+                for (size_t tier = small_tiers.size() - 1; tier > 0; --tier)
+                {
+                    parallel_for(small_tiers[tier - 1], small_tiers[tier], thread_count, [&](uint64_t first, uint64_t last) {
+                        for (uint64_t v = first; v < last; ++v)
+                            small[v] -= small[by_p.divide(v)] - primes_below_p;
+                    });
+                }
+            }
+        }
+
+        return large[1];
+    }
+} // namespace Math::Primes
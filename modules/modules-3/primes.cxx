@@ -2,40 +2,709 @@ module; // global fragment module
 
 #include <algorithm>
 #include <array>
+#include <bit>
+#include <concepts>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <iterator>
 #include <limits>
 #include <ranges>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
 
 export module Math:Primes;
 
 namespace Math::Primes
 {
-    export constexpr bool is_prime(uint32_t n)
+    ////////////////////////////////////////////////////////////////////
+    // deterministic Miller-Rabin test with Montgomery arithmetic
+
+    struct WideProduct
+    {
+        uint64_t high;
+        uint64_t low;
+    };
+
+    constexpr WideProduct multiply_wide(uint64_t a, uint64_t b) noexcept
+    {
+#ifdef __SIZEOF_INT128__
+        const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        return {static_cast<uint64_t>(product >> 64), static_cast<uint64_t>(product)};
+#else
+        const uint64_t a_lo = a & 0xFFFFFFFF, a_hi = a >> 32;
+        const uint64_t b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+
+        const uint64_t lo_lo = a_lo * b_lo;
+        const uint64_t hi_lo = a_hi * b_lo;
+        const uint64_t lo_hi = a_lo * b_hi;
+        const uint64_t hi_hi = a_hi * b_hi;
+
+        const uint64_t middle = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+        return {hi_hi + (hi_lo >> 32) + (middle >> 32), (middle << 32) | (lo_lo & 0xFFFFFFFF)};
+#endif
+    }
+
+    constexpr WideProduct multiply_wide(uint32_t a, uint32_t b) noexcept
+    {
+        const uint64_t product = uint64_t{a} * b;
+        return {product >> 32, product & 0xFFFFFFFF};
+    }
+
+    // arithmetic modulo odd n on numbers in Montgomery form (a * 2^bits mod n)
+    template <typename T>
+        requires std::same_as<T, uint32_t> || std::same_as<T, uint64_t>
+    class Montgomery
     {
-        if (n <= 1)
-            return false;
+        T n_;
+        T n_inverse_;   // n^-1 mod 2^bits
+        T one_;         // 2^bits mod n
+        T r_squared_;   // 2^(2 * bits) mod n
+
+    public:
+        constexpr explicit Montgomery(T n) noexcept
+            : n_{n}
+            , n_inverse_{n}
+        {
+            for (int i = 0; i < 6; ++i) // Newton's iteration - every step doubles the number of correct bits
+                n_inverse_ *= T(2) - n * n_inverse_;
+
+            one_ = static_cast<T>(-n) % n;
+            r_squared_ = one_;
+            for (int i = 0; i < std::numeric_limits<T>::digits; ++i)
+                r_squared_ = add(r_squared_, r_squared_);
+        }
+
+        constexpr T modulus() const noexcept
+        {
+            return n_;
+        }
+
+        constexpr T one() const noexcept
+        {
+            return one_;
+        }
+
+        constexpr T to_montgomery(T a) const noexcept
+        {
+            return multiply(a % n_, r_squared_);
+        }
+
+        constexpr T add(T a, T b) const noexcept
+        {
+            const T sum = a + b;
+            return (sum < a || sum >= n_) ? sum - n_ : sum;
+        }
 
-        for (auto i = 2u; i < n; ++i)
+        constexpr T multiply(T a, T b) const noexcept
         {
-            if (n % i == 0)
+            const auto [high, low] = multiply_wide(a, b);
+            const T m = static_cast<T>(low) * n_inverse_;
+            const T mn_high = static_cast<T>(multiply_wide(m, n_).high);
+
+            return static_cast<T>(high) >= mn_high ? static_cast<T>(high) - mn_high : static_cast<T>(high) + n_ - mn_high;
+        }
+
+        constexpr T power(T base, T exponent) const noexcept
+        {
+            T result = one_;
+            for (; exponent != 0; exponent >>= 1)
+            {
+                if (exponent & 1)
+                    result = multiply(result, base);
+                base = multiply(base, base);
+            }
+            return result;
+        }
+    };
+
+    inline constexpr std::array<uint32_t, 15> small_primes = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47};
+
+    // bases giving deterministic results for all 32-bit and 64-bit numbers
+    inline constexpr std::array<uint64_t, 3> witnesses_32 = {2, 7, 61};
+    inline constexpr std::array<uint64_t, 7> witnesses_64 = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+
+    enum class Verdict
+    {
+        composite,
+        prime,
+        unknown
+    };
+
+    // trial division by small primes - decides all numbers below 53^2
+    constexpr Verdict small_primes_filter(uint64_t n) noexcept
+    {
+        if (n < 2)
+            return Verdict::composite;
+
+        for (uint32_t p : small_primes)
+        {
+            if (n % p == 0)
+                return n == p ? Verdict::prime : Verdict::composite;
+        }
+
+        return n < 53 * 53 ? Verdict::prime : Verdict::unknown;
+    }
+
+    // strong probable prime test for odd n > 2 and n - 1 = d * 2^s
+    template <std::unsigned_integral T>
+    constexpr bool is_strong_probable_prime(const Montgomery<T>& mont, T d, int s, uint64_t witness) noexcept
+    {
+        const T n = mont.modulus();
+        const T a = static_cast<T>(witness % n);
+        if (a == 0)
+            return true;
+
+        const T minus_one = n - mont.one();
+        T x = mont.power(mont.to_montgomery(a), d);
+
+        if (x == mont.one() || x == minus_one)
+            return true;
+
+        for (int r = 1; r < s; ++r)
+        {
+            x = mont.multiply(x, x);
+            if (x == minus_one)
+                return true;
+        }
+
+        return false;
+    }
+
+    template <std::unsigned_integral T>
+    constexpr bool miller_rabin(T n) noexcept
+    {
+        const Montgomery<T> mont{n};
+        const int s = std::countr_zero(static_cast<T>(n - 1));
+        const T d = static_cast<T>(n - 1) >> s;
+
+        const auto test = [&](const auto& witnesses) {
+            return std::ranges::all_of(witnesses, [&](uint64_t w) { return is_strong_probable_prime(mont, d, s, w); });
+        };
+
+        if constexpr (sizeof(T) <= sizeof(uint32_t))
+            return test(witnesses_32);
+        else
+            return test(witnesses_64);
+    }
+
+    // the same as miller_rabin() for a few numbers at once - independent multiplications hide their latency
+    template <size_t Lanes>
+    void miller_rabin_interleaved(const std::array<uint64_t, Lanes>& numbers, std::array<bool, Lanes>& results) noexcept
+    {
+        const auto monts = [&]<size_t... I>(std::index_sequence<I...>) {
+            return std::array{Montgomery<uint64_t>{numbers[I]}...};
+        }(std::make_index_sequence<Lanes>{});
+
+        std::array<uint64_t, Lanes> d{}; // n - 1 = d * 2^s
+        std::array<int, Lanes> s{};
+        int max_bits = 0;
+
+        for (size_t lane = 0; lane < Lanes; ++lane)
+        {
+            s[lane] = std::countr_zero(numbers[lane] - 1);
+            d[lane] = (numbers[lane] - 1) >> s[lane];
+            max_bits = std::max(max_bits, static_cast<int>(std::bit_width(d[lane])));
+            results[lane] = true;
+        }
+
+        for (uint64_t witness : witnesses_64)
+        {
+            std::array<uint64_t, Lanes> base{};
+            std::array<uint64_t, Lanes> x{};
+            for (size_t lane = 0; lane < Lanes; ++lane)
+            {
+                base[lane] = monts[lane].to_montgomery(witness);
+                x[lane] = monts[lane].one();
+            }
+
+            // left-to-right exponentiation in lockstep - leading zero bits only square one
+            for (int bit = max_bits - 1; bit >= 0; --bit)
+            {
+                for (size_t lane = 0; lane < Lanes; ++lane)
+                {
+                    x[lane] = monts[lane].multiply(x[lane], x[lane]);
+                    const uint64_t product = monts[lane].multiply(x[lane], base[lane]);
+                    x[lane] = ((d[lane] >> bit) & 1) ? product : x[lane];
+                }
+            }
+
+            for (size_t lane = 0; lane < Lanes; ++lane)
+            {
+                const auto& mont = monts[lane];
+                const uint64_t minus_one = mont.modulus() - mont.one();
+
+                if (!results[lane] || witness % mont.modulus() == 0 || x[lane] == mont.one() || x[lane] == minus_one)
+                    continue;
+
+                bool passed = false;
+                for (int r = 1; r < s[lane] && !passed; ++r)
+                {
+                    x[lane] = mont.multiply(x[lane], x[lane]);
+                    passed = (x[lane] == minus_one);
+                }
+                results[lane] = passed;
+            }
+        }
+    }
+
+    struct IsPrime
+    {
+        constexpr bool operator()(std::integral auto n) const noexcept
+        {
+            if (n < 2)
                 return false;
+
+            const auto value = static_cast<uint64_t>(n);
+
+            if (const Verdict verdict = small_primes_filter(value); verdict != Verdict::unknown)
+                return verdict == Verdict::prime;
+
+            if (value <= std::numeric_limits<uint32_t>::max())
+                return miller_rabin(static_cast<uint32_t>(value));
+
+            return miller_rabin(value);
+        }
+
+        // results[i] = is_prime(candidates[i])
+        void operator()(std::span<const uint64_t> candidates, std::span<bool> results) const noexcept
+        {
+            constexpr size_t lanes = 4;
+
+            std::array<size_t, lanes> pending_indexes{};
+            std::array<uint64_t, lanes> pending{};
+            std::array<bool, lanes> pending_results{};
+            size_t pending_count = 0;
+
+            for (size_t i = 0; i < candidates.size(); ++i)
+            {
+                const uint64_t n = candidates[i];
+
+                if (const Verdict verdict = small_primes_filter(n); verdict != Verdict::unknown)
+                {
+                    results[i] = (verdict == Verdict::prime);
+                    continue;
+                }
+
+                pending_indexes[pending_count] = i;
+                pending[pending_count] = n;
+
+                if (++pending_count == lanes)
+                {
+                    miller_rabin_interleaved(pending, pending_results);
+                    for (size_t lane = 0; lane < lanes; ++lane)
+                        results[pending_indexes[lane]] = pending_results[lane];
+                    pending_count = 0;
+                }
+            }
+
+            for (size_t lane = 0; lane < pending_count; ++lane)
+                results[pending_indexes[lane]] = (*this)(pending[lane]);
         }
+    };
+
+    export constexpr IsPrime is_prime{};
 
-        return true;
+    // first multiple of odd prime p that is >= max(p * p, low) and odd
+    constexpr uint64_t first_odd_multiple(uint64_t p, uint64_t low)
+    {
+        uint64_t multiple = std::max(p * p, (low + p - 1) / p * p);
+        if (multiple % 2 == 0)
+            multiple += p;
+        return multiple;
     }
 
+    // segmented sieve of Eratosthenes over odd numbers - near-linear, so it stays cheap in constant evaluation
     export template <uint32_t N>
     constexpr std::array<uint32_t, N> get_primes()
     {
         std::array<uint32_t, N> primes{};
 
-        auto primes_view = std::views::iota(2u) | std::views::filter(is_prime) | std::views::take(N);
+        if constexpr (N > 0)
+        {
+            constexpr uint64_t segment_size = 1 << 13; // odd numbers per segment
+            std::vector<uint8_t> is_composite(segment_size);
+
+            primes[0] = 2;
+            uint32_t count = 1;
+
+            for (uint64_t low = 3; count < N; low += 2 * segment_size)
+            {
+                const uint64_t high = low + 2 * segment_size; // segment covers odd numbers in [low, high)
+                std::ranges::fill(is_composite, 0);
 
-        std::ranges::copy(primes_view, primes.begin());
+                auto cross_off = [&](uint64_t p) {
+                    for (uint64_t multiple = first_odd_multiple(p, low); multiple < high; multiple += 2 * p)
+                        is_composite[(multiple - low) / 2] = 1;
+                };
+
+                // primes from previous segments
+                for (uint32_t i = 1; i < count && uint64_t{primes[i]} * primes[i] < high; ++i)
+                    cross_off(primes[i]);
+
+                for (uint64_t i = 0; i < segment_size && count < N; ++i)
+                {
+                    if (is_composite[i])
+                        continue;
+
+                    const uint64_t p = low + 2 * i;
+                    primes[count++] = static_cast<uint32_t>(p);
+
+                    if (p * p < high)
+                        cross_off(p);
+                }
+            }
+        }
 
         return primes;
     }
 
     export constexpr std::array first_primes = get_primes<100>();
+
+    ////////////////////////////////////////////////////////////////////
+    // runtime sieve - bit-packed odd numbers, cache-sized segments
+
+    // odd numbers divisible by the wheel primes are removed by copying a precomputed pattern
+    inline constexpr std::array<uint32_t, 5> wheel_primes = {3, 5, 7, 11, 13};
+    inline constexpr size_t wheel_pattern_size = 3 * 5 * 7 * 11 * 13; // bytes - 8 odd numbers per byte
+
+    constexpr std::array<uint8_t, wheel_pattern_size> make_wheel_pattern()
+    {
+        std::array<uint8_t, wheel_pattern_size> pattern{};
+
+        for (uint32_t p : wheel_primes)
+        {
+            for (uint64_t bit = p / 2; bit < 8 * wheel_pattern_size; bit += p) // bit i - odd number 2 * i + 1
+                pattern[bit / 8] |= static_cast<uint8_t>(1 << (bit % 8));
+        }
+
+        return pattern;
+    }
+
+    inline constexpr std::array<uint8_t, wheel_pattern_size> wheel_pattern = make_wheel_pattern();
+
+    uint64_t integer_sqrt(uint64_t n)
+    {
+        auto root = static_cast<uint64_t>(std::sqrt(static_cast<double>(n)));
+        while (root * root > n)
+            --root;
+        while ((root + 1) * (root + 1) <= n)
+            ++root;
+        return root;
+    }
+
+    // sieving primes (> 13) up to and including sqrt(limit)
+    std::vector<uint32_t> sieving_primes(uint64_t limit)
+    {
+        const auto max_prime = static_cast<uint32_t>(integer_sqrt(limit));
+
+        std::vector<uint8_t> is_composite(max_prime + 1);
+        std::vector<uint32_t> primes;
+
+        for (uint32_t n = 3; n <= max_prime; n += 2)
+        {
+            if (is_composite[n])
+                continue;
+
+            if (n > wheel_primes.back())
+                primes.push_back(n);
+
+            for (uint64_t multiple = uint64_t{n} * n; multiple <= max_prime; multiple += 2 * n)
+                is_composite[multiple] = 1;
+        }
+
+        return primes;
+    }
+
+    unsigned default_thread_count()
+    {
+        return std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    class SegmentedSieve
+    {
+    public:
+        static constexpr size_t segment_bytes = 32 * 1024; // fits in L1 cache
+        static constexpr uint64_t segment_span = 16 * segment_bytes; // numbers covered by one segment
+
+    private:
+        std::span<const uint32_t> sieving_primes_;
+        std::vector<uint8_t> composites_ = std::vector<uint8_t>(segment_bytes); // bit i - low + 2 * i is composite
+        uint64_t low_ = 0;
+
+    public:
+        explicit SegmentedSieve(std::span<const uint32_t> sieving_primes)
+            : sieving_primes_{sieving_primes}
+        { }
+
+        // sieves odd numbers in [low, low + segment_span) - low must be equal to k * segment_span + 1
+        void sieve(uint64_t low)
+        {
+            low_ = low;
+
+            size_t pattern_pos = ((low - 1) / 16) % wheel_pattern_size;
+            for (size_t copied = 0; copied < segment_bytes;)
+            {
+                const size_t chunk = std::min(segment_bytes - copied, wheel_pattern_size - pattern_pos);
+                std::memcpy(composites_.data() + copied, wheel_pattern.data() + pattern_pos, chunk);
+                copied += chunk;
+                pattern_pos = 0;
+            }
+
+            if (low == 1)
+            {
+                composites_[0] |= 1; // 1 is not a prime
+                for (uint32_t p : wheel_primes)
+                    composites_[p / 16] &= static_cast<uint8_t>(~(1 << ((p / 2) % 8)));
+            }
+
+            const uint64_t high = low + segment_span;
+            const uint64_t bit_count = 8 * segment_bytes;
+
+            for (uint32_t p : sieving_primes_)
+            {
+                if (uint64_t{p} * p >= high)
+                    break;
+
+                for (uint64_t bit = (first_odd_multiple(p, low) - low) / 2; bit < bit_count; bit += p)
+                    composites_[bit / 8] |= static_cast<uint8_t>(1 << (bit % 8));
+            }
+        }
+
+        // calls f(prime) for odd primes of the sieved segment that are less than limit
+        template <typename TFunction>
+        void for_each_prime(uint64_t limit, TFunction f) const
+        {
+            const size_t word_count = words_below(limit);
+
+            for (size_t w = 0; w < word_count; ++w)
+            {
+                for (uint64_t primes = ~word(w, limit); primes != 0; primes &= primes - 1)
+                    f(low_ + 2 * (64 * w + std::countr_zero(primes)));
+            }
+        }
+
+        // number of odd primes of the sieved segment that are less than limit
+        uint64_t count(uint64_t limit) const
+        {
+            uint64_t result = 0;
+            const size_t word_count = words_below(limit);
+
+            for (size_t w = 0; w < word_count; ++w)
+                result += std::popcount(~word(w, limit));
+
+            return result;
+        }
+
+    private:
+        size_t words_below(uint64_t limit) const noexcept
+        {
+            if (limit <= low_)
+                return 0;
+            return static_cast<size_t>(std::min<uint64_t>((limit - low_ + 127) / 128, segment_bytes / 8));
+        }
+
+        // composites bits for 64 odd numbers - numbers >= limit are reported as composites
+        uint64_t word(size_t index, uint64_t limit) const noexcept
+        {
+            uint64_t result = 0;
+            for (size_t byte = 0; byte < 8; ++byte) // compiled to a single load on little-endian targets
+                result |= uint64_t{composites_[8 * index + byte]} << (8 * byte);
+
+            const uint64_t first = low_ + 128 * index;
+            if (first + 128 > limit)
+            {
+                const uint64_t valid_bits = (limit - first + 1) / 2;
+                if (valid_bits < 64)
+                    result |= ~uint64_t{0} << valid_bits;
+            }
+
+            return result;
+        }
+    };
+
+    // calls f(thread_index, first_segment_low, last_segment_low) for contiguous groups of segments
+    template <typename TFunction>
+    void for_each_segment_group(uint64_t limit, unsigned thread_count, TFunction f)
+    {
+        const uint64_t segment_count = (limit + SegmentedSieve::segment_span - 1) / SegmentedSieve::segment_span;
+        thread_count = static_cast<unsigned>(std::clamp<uint64_t>(segment_count, 1, std::max(thread_count, 1u)));
+
+        std::vector<std::jthread> workers;
+        for (unsigned t = 0; t < thread_count; ++t)
+        {
+            const uint64_t first = segment_count * t / thread_count * SegmentedSieve::segment_span + 1;
+            const uint64_t last = segment_count * (t + 1) / thread_count * SegmentedSieve::segment_span + 1;
+
+            if (t + 1 == thread_count)
+                f(t, first, last);
+            else
+                workers.emplace_back([=] { f(t, first, last); });
+        }
+    }
+
+    // all primes less than limit
+    export std::vector<uint64_t> primes_below(uint64_t limit, unsigned thread_count = default_thread_count())
+    {
+        if (limit <= 2)
+            return {};
+
+        const std::vector<uint32_t> base_primes = sieving_primes(limit);
+        std::vector<std::vector<uint64_t>> partial_results(std::max(thread_count, 1u));
+
+        for_each_segment_group(limit, thread_count, [&](unsigned t, uint64_t first, uint64_t last) {
+            SegmentedSieve sieve{base_primes};
+            auto& primes = partial_results[t];
+
+            for (uint64_t low = first; low < last && low < limit; low += SegmentedSieve::segment_span)
+            {
+                sieve.sieve(low);
+                sieve.for_each_prime(limit, [&](uint64_t p) { primes.push_back(p); });
+            }
+        });
+
+        size_t total_count = 1;
+        for (const auto& partial : partial_results)
+            total_count += partial.size();
+
+        std::vector<uint64_t> primes;
+        primes.reserve(total_count);
+        primes.push_back(2);
+        for (const auto& partial : partial_results)
+            primes.insert(primes.end(), partial.begin(), partial.end());
+
+        return primes;
+    }
+
+    // number of primes less than limit
+    export uint64_t count_primes_below(uint64_t limit, unsigned thread_count = default_thread_count())
+    {
+        if (limit <= 2)
+            return 0;
+
+        const std::vector<uint32_t> base_primes = sieving_primes(limit);
+        std::vector<uint64_t> partial_counts(std::max(thread_count, 1u));
+
+        for_each_segment_group(limit, thread_count, [&](unsigned t, uint64_t first, uint64_t last) {
+            SegmentedSieve sieve{base_primes};
+
+            for (uint64_t low = first; low < last && low < limit; low += SegmentedSieve::segment_span)
+            {
+                sieve.sieve(low);
+                partial_counts[t] += sieve.count(limit);
+            }
+        });
+
+        uint64_t count = 1; // 2
+        for (uint64_t partial : partial_counts)
+            count += partial;
+
+        return count;
+    }
+
+    // lazy range of primes from [first, limit) - segments are sieved on demand (like std::ranges::istream_view)
+    export class PrimesView : public std::ranges::view_interface<PrimesView>
+    {
+        uint64_t first_;
+        uint64_t limit_;
+        std::vector<uint32_t> base_primes_;
+        SegmentedSieve sieve_;
+        std::vector<uint64_t> buffer_; // primes of the current segment
+        size_t pos_ = 0;
+        uint64_t next_low_;
+
+        void load_next_segment()
+        {
+            buffer_.clear();
+            pos_ = 0;
+
+            for (; buffer_.empty() && next_low_ < limit_; next_low_ += SegmentedSieve::segment_span)
+            {
+                sieve_.sieve(next_low_);
+                sieve_.for_each_prime(limit_, [this](uint64_t p) {
+                    if (p >= first_)
+                        buffer_.push_back(p);
+                });
+            }
+        }
+
+    public:
+        class iterator
+        {
+            PrimesView* view_;
+
+        public:
+            using value_type = uint64_t;
+            using difference_type = std::ptrdiff_t;
+            using iterator_concept = std::input_iterator_tag;
+
+            explicit iterator(PrimesView& view)
+                : view_{&view}
+            { }
+
+            iterator(iterator&&) = default;
+            iterator& operator=(iterator&&) = default;
+
+            uint64_t operator*() const
+            {
+                return view_->buffer_[view_->pos_];
+            }
+
+            iterator& operator++()
+            {
+                if (++view_->pos_ == view_->buffer_.size())
+                    view_->load_next_segment();
+                return *this;
+            }
+
+            void operator++(int)
+            {
+                ++*this;
+            }
+
+            bool operator==(std::default_sentinel_t) const
+            {
+                return view_->buffer_.empty();
+            }
+        };
+
+        PrimesView(uint64_t first, uint64_t limit)
+            : first_{first}
+            , limit_{limit}
+            , base_primes_{sieving_primes(limit)}
+            , sieve_{base_primes_}
+            , next_low_{first / SegmentedSieve::segment_span * SegmentedSieve::segment_span + 1}
+        {
+            if (first_ <= 2 && limit_ > 2)
+                buffer_.push_back(2);
+            else
+                load_next_segment();
+        }
+
+        // moved vectors keep their buffers, so the sieve still refers to valid sieving primes
+        PrimesView(PrimesView&&) = default;
+        PrimesView& operator=(PrimesView&&) = default;
+
+        iterator begin()
+        {
+            return iterator{*this};
+        }
+
+        std::default_sentinel_t end() const noexcept
+        {
+            return std::default_sentinel;
+        }
+    };
+
+    export PrimesView primes_view(uint64_t limit)
+    {
+        return PrimesView{0, limit};
+    }
+
+    export PrimesView primes_view(uint64_t first, uint64_t limit)
+    {
+        return PrimesView{first, limit};
+    }
 }
\ No newline at end of file
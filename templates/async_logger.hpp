@@ -0,0 +1,623 @@
+#ifndef ASYNC_LOGGER_HPP
+#define ASYNC_LOGGER_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <charconv>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// asynchronous logging - a call site stores its arguments in binary form in a lock-free ring of the calling thread,
+// a background thread formats the records and writes them to the sink in batches
+namespace logging
+{
+    template <typename T>
+    concept StringLike = std::convertible_to<const T&, std::string_view>;
+
+    template <typename T>
+    concept Loggable = std::is_arithmetic_v<T> || std::is_pointer_v<T> || StringLike<T>;
+
+    enum class Level : uint8_t
+    {
+        trace,
+        debug,
+        info,
+        warning,
+        error,
+        off
+    };
+
+    // minimal level of the loggers matching the pattern: a logger name, a category prefix ending with '.'
+    // (e.g. "net." matches "net.tcp") or "*" for all loggers
+    struct LogRule
+    {
+        std::string_view pattern;
+        Level min_level;
+    };
+
+    // level of the longest matching rule - statements below it are not compiled in
+    template <size_t N>
+    consteval Level min_level(std::string_view name, const LogRule (&rules)[N])
+    {
+        Level level = Level::trace;
+        size_t match_length = 0;
+        bool matched = false;
+
+        for (const LogRule& rule : rules)
+        {
+            const bool matches = (rule.pattern == "*")
+                || (rule.pattern.ends_with('.') ? name.starts_with(rule.pattern) : name == rule.pattern);
+            const size_t length = (rule.pattern == "*") ? 0 : rule.pattern.size();
+
+            if (matches && (!matched || length > match_length))
+            {
+                level = rule.min_level;
+                match_length = length;
+                matched = true;
+            }
+        }
+
+        return level;
+    }
+
+    namespace details
+    {
+        inline std::atomic<Level> runtime_level{Level::trace};
+    }
+
+    // runtime filter on top of the compile-time rules
+    inline void set_level(Level level) noexcept
+    {
+        details::runtime_level.store(level, std::memory_order_relaxed);
+    }
+
+    inline Level level() noexcept
+    {
+        return details::runtime_level.load(std::memory_order_relaxed);
+    }
+
+    inline bool is_enabled(Level level) noexcept
+    {
+        return level >= details::runtime_level.load(std::memory_order_relaxed);
+    }
+
+    namespace details
+    {
+        ///////////////////////////////////////////////////////////////////////
+        // format strings - "{}" is a placeholder, "{{" and "}}" are escaped braces
+
+        // number of placeholders - malformed formats are rejected at compile time
+        consteval size_t placeholder_count(std::string_view format)
+        {
+            size_t count = 0;
+            for (size_t i = 0; i < format.size(); ++i)
+            {
+                if (format[i] == '{')
+                {
+                    if (i + 1 == format.size())
+                        throw "unmatched '{' in format string";
+                    if (format[i + 1] == '}')
+                        ++count;
+                    else if (format[i + 1] != '{')
+                        throw "only {} placeholders are supported";
+                    ++i;
+                }
+                else if (format[i] == '}')
+                {
+                    if (i + 1 == format.size() || format[i + 1] != '}')
+                        throw "unmatched '}' in format string";
+                    ++i;
+                }
+            }
+            return count;
+        }
+
+        // literal text of a format split at the placeholders: piece i is text[bounds[i], bounds[i + 1])
+        template <size_t TextSize, size_t PieceCount>
+        struct ParsedFormat
+        {
+            std::array<char, TextSize> text{};
+            std::array<size_t, PieceCount + 1> bounds{};
+
+            constexpr std::string_view piece(size_t i) const
+            {
+                return {text.data() + bounds[i], bounds[i + 1] - bounds[i]};
+            }
+        };
+
+        template <auto Format>
+        consteval auto parse_format()
+        {
+            constexpr std::string_view format{Format.text};
+            constexpr size_t piece_count = placeholder_count(format) + 1;
+
+            ParsedFormat<format.size() + 1, piece_count> parsed;
+            size_t length = 0;
+            size_t piece = 0;
+            for (size_t i = 0; i < format.size(); ++i)
+            {
+                if (format[i] == '{' && format[i + 1] == '}')
+                {
+                    parsed.bounds[++piece] = length;
+                    ++i;
+                    continue;
+                }
+                parsed.text[length++] = format[i];
+                if (format[i] == '{' || format[i] == '}')
+                    ++i;
+            }
+            parsed.bounds[piece_count] = length;
+
+            return parsed;
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        // binary encoding of arguments - strings are copied as length + bytes
+
+        template <typename T>
+        using Encoded = std::conditional_t<StringLike<T>, std::string_view, T>;
+
+        constexpr size_t max_string_size = 4096; // longer strings are truncated
+
+        template <typename T>
+        size_t encoded_size(const T& value) noexcept
+        {
+            if constexpr (StringLike<T>)
+                return sizeof(uint32_t) + std::min(std::string_view{value}.size(), max_string_size);
+            else
+                return sizeof(T);
+        }
+
+        template <typename T>
+        std::byte* encode(std::byte* out, const T& value) noexcept
+        {
+            if constexpr (StringLike<T>)
+            {
+                const std::string_view str{value};
+                const auto size = static_cast<uint32_t>(std::min(str.size(), max_string_size));
+                std::memcpy(out, &size, sizeof(size));
+                std::memcpy(out + sizeof(size), str.data(), size);
+                return out + sizeof(size) + size;
+            }
+            else
+            {
+                std::memcpy(out, &value, sizeof(T));
+                return out + sizeof(T);
+            }
+        }
+
+        template <typename T>
+        T decode(const std::byte*& in) noexcept
+        {
+            if constexpr (std::same_as<T, std::string_view>)
+            {
+                uint32_t size;
+                std::memcpy(&size, in, sizeof(size));
+                const std::string_view str{reinterpret_cast<const char*>(in + sizeof(size)), size};
+                in += sizeof(size) + size;
+                return str;
+            }
+            else
+            {
+                T value;
+                std::memcpy(&value, in, sizeof(T));
+                in += sizeof(T);
+                return value;
+            }
+        }
+
+        template <typename T>
+        void append_value(std::string& out, T value)
+        {
+            if constexpr (std::same_as<T, std::string_view>)
+                out += value;
+            else if constexpr (std::same_as<T, bool>)
+                out += value ? "true" : "false";
+            else if constexpr (std::same_as<T, char>)
+                out += value;
+            else if constexpr (std::is_pointer_v<T>)
+            {
+                char buffer[2 + 16];
+                buffer[0] = '0';
+                buffer[1] = 'x';
+                const auto result = std::to_chars(buffer + 2, std::end(buffer), reinterpret_cast<uintptr_t>(value), 16);
+                out.append(buffer, result.ptr);
+            }
+            else
+            {
+                char buffer[64];
+                const auto result = std::to_chars(std::begin(buffer), std::end(buffer), value);
+                out.append(buffer, result.ptr);
+            }
+        }
+
+        // formats the encoded arguments of a record as a line of the log
+        using FormatFunction = const std::byte* (*)(const std::byte* args, std::string& out);
+
+        template <auto LogName, auto Format, typename... TArgs>
+        const std::byte* format_record(const std::byte* args, std::string& out)
+        {
+            static constexpr auto parsed = parse_format<Format>();
+
+            const std::tuple<TArgs...> values{decode<TArgs>(args)...}; // braced init - decoded in order
+
+            out += std::string_view{LogName.text};
+            out += ": ";
+            [&]<size_t... Is>(std::index_sequence<Is...>) {
+                ((out += parsed.piece(Is), append_value(out, std::get<Is>(values))), ...);
+            }(std::index_sequence_for<TArgs...>{});
+            out += parsed.piece(sizeof...(TArgs));
+            out += '\n';
+
+            return args;
+        }
+
+        ///////////////////////////////////////////////////////////////////////
+        // single producer - single consumer ring of variable sized records
+
+        struct RecordHeader
+        {
+            uint64_t size;          // of the whole record including the header
+            FormatFunction format;  // nullptr - padding up to the end of the buffer
+        };
+
+        constexpr size_t record_alignment = 16;
+
+        static_assert(sizeof(RecordHeader) <= record_alignment);
+
+        class SpscRing
+        {
+            std::unique_ptr<std::byte[]> buffer_;
+            size_t capacity_;
+
+            alignas(64) std::atomic<size_t> head_{0}; // written by the producer
+            size_t cached_tail_ = 0;
+            size_t reserved_head_ = 0;
+
+            alignas(64) std::atomic<size_t> tail_{0}; // written by the consumer
+
+            std::atomic<bool> abandoned_{false};
+
+        public:
+            // capacity must be a power of 2
+            explicit SpscRing(size_t capacity)
+                : buffer_{std::make_unique<std::byte[]>(capacity)}
+                , capacity_{capacity}
+            { }
+
+            size_t capacity() const noexcept
+            {
+                return capacity_;
+            }
+
+            // producer: contiguous space for a record of the given size (multiple of record_alignment, at most half of
+            // the capacity) or nullptr if the ring is full
+            std::byte* try_reserve(size_t size) noexcept
+            {
+                size_t head = head_.load(std::memory_order_relaxed);
+                const size_t offset = head & (capacity_ - 1);
+                const size_t contiguous = capacity_ - offset;
+                const size_t needed = (contiguous < size) ? size + contiguous : size;
+
+                if (head + needed - cached_tail_ > capacity_)
+                {
+                    cached_tail_ = tail_.load(std::memory_order_acquire);
+                    if (head + needed - cached_tail_ > capacity_)
+                        return nullptr;
+                }
+
+                if (contiguous < size) // records never wrap - the rest of the buffer is skipped
+                {
+                    const RecordHeader padding{contiguous, nullptr};
+                    std::memcpy(buffer_.get() + offset, &padding, sizeof(padding));
+                    head += contiguous;
+                }
+
+                reserved_head_ = head;
+                return buffer_.get() + (head & (capacity_ - 1));
+            }
+
+            // producer: publishes the reserved record - returns true if the consumer had drained the ring before
+            bool commit(size_t size) noexcept
+            {
+                const size_t previous_head = head_.load(std::memory_order_relaxed);
+                head_.store(reserved_head_ + size, std::memory_order_release);
+                std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with the fence of the sleeping consumer
+                return tail_.load(std::memory_order_relaxed) == previous_head;
+            }
+
+            // consumer: calls f(header, args) for every published record
+            template <typename TFunction>
+            size_t consume(TFunction f)
+            {
+                const size_t head = head_.load(std::memory_order_acquire);
+                size_t tail = tail_.load(std::memory_order_relaxed);
+                size_t count = 0;
+
+                while (tail != head)
+                {
+                    const std::byte* record = buffer_.get() + (tail & (capacity_ - 1));
+                    RecordHeader header;
+                    std::memcpy(&header, record, sizeof(header));
+                    if (header.format)
+                    {
+                        f(header, record + sizeof(RecordHeader));
+                        ++count;
+                    }
+                    tail += header.size;
+                }
+
+                tail_.store(tail, std::memory_order_release);
+                return count;
+            }
+
+            bool empty() const noexcept
+            {
+                return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_relaxed);
+            }
+
+            // the producing thread has exited - the ring is dropped once drained
+            void abandon() noexcept
+            {
+                abandoned_.store(true, std::memory_order_release);
+            }
+
+            bool is_abandoned() const noexcept
+            {
+                return abandoned_.load(std::memory_order_acquire);
+            }
+        };
+
+        ///////////////////////////////////////////////////////////////////////
+        // background thread draining the rings of all threads
+
+        class Backend
+        {
+            std::mutex mutex_; // guards the rings registered since the last drain and the flush / stop requests
+            std::condition_variable flushed_;
+            std::vector<std::shared_ptr<SpscRing>> new_rings_;
+            uint64_t flush_requested_ = 0;
+            uint64_t flush_completed_ = 0;
+            bool stop_ = false;
+
+            std::mutex sink_mutex_; // held while a batch is written - set_sink() waits for the batch in progress
+            std::ostream* sink_ = &std::cout;
+
+            // used only by the background thread
+            std::vector<std::shared_ptr<SpscRing>> rings_;
+            std::string batch_;
+
+            // the sleeping thread waits for a change of the sequence - waking it up takes no lock
+            std::atomic<uint32_t> wake_sequence_{0};
+            std::atomic<bool> sleeping_{false};
+
+            std::thread worker_;
+
+            bool all_rings_empty() const noexcept
+            {
+                return std::ranges::all_of(rings_, [](const auto& ring) { return ring->empty(); });
+            }
+
+            size_t drain()
+            {
+                size_t count = 0;
+                for (const auto& ring : rings_)
+                    count += ring->consume([this](const RecordHeader& header, const std::byte* args) { header.format(args, batch_); });
+
+                std::erase_if(rings_, [](const auto& ring) { return ring->is_abandoned() && ring->empty(); });
+
+                if (!batch_.empty())
+                {
+                    sink_->write(batch_.data(), static_cast<std::streamsize>(batch_.size()));
+                    batch_.clear();
+                }
+
+                return count;
+            }
+
+            // polls the rings for a while before sleeping - producers logging at a steady pace find the thread awake
+            // and never pay for a wake-up
+            void wait_for_records(uint32_t sequence)
+            {
+                const auto poll_end = std::chrono::steady_clock::now() + idle_poll_time;
+                while (std::chrono::steady_clock::now() < poll_end)
+                {
+                    if (wake_sequence_.load(std::memory_order_acquire) != sequence || !all_rings_empty())
+                        return;
+                    std::this_thread::yield();
+                }
+
+                // the rings are checked again after announcing the sleep - a record published in between
+                // is either seen here or its producer sees sleeping_ and bumps the sequence
+                sleeping_.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (all_rings_empty())
+                    wake_sequence_.wait(sequence, std::memory_order_acquire);
+                sleeping_.store(false, std::memory_order_relaxed);
+            }
+
+            void run()
+            {
+                while (true)
+                {
+                    // read before the requests - a request or a ring registered later changes the sequence
+                    const uint32_t sequence = wake_sequence_.load(std::memory_order_acquire);
+
+                    uint64_t requested;
+                    bool stopping;
+                    {
+                        std::lock_guard lock{mutex_};
+                        requested = flush_requested_;
+                        stopping = stop_;
+                        for (auto& ring : new_rings_)
+                            rings_.push_back(std::move(ring));
+                        new_rings_.clear();
+                    }
+
+                    size_t count;
+                    {
+                        // formatting and writing do not hold mutex_ - register_thread() and flush() never wait for the sink
+                        std::lock_guard sink_lock{sink_mutex_};
+                        count = drain();
+                        if (requested != flush_completed_ || (stopping && count == 0))
+                            sink_->flush();
+                    }
+
+                    if (requested != flush_completed_)
+                    {
+                        {
+                            std::lock_guard lock{mutex_};
+                            flush_completed_ = requested;
+                        }
+                        flushed_.notify_all();
+                    }
+
+                    if (stopping && count == 0)
+                        return;
+
+                    if (count == 0)
+                        wait_for_records(sequence);
+                }
+            }
+
+            void wake() noexcept
+            {
+                wake_sequence_.fetch_add(1, std::memory_order_release);
+                wake_sequence_.notify_one();
+            }
+
+        public:
+            static constexpr size_t ring_capacity = 1 << 18;
+            static constexpr std::chrono::microseconds idle_poll_time{200};
+
+            Backend()
+                : worker_{[this] { run(); }}
+            { }
+
+            Backend(const Backend&) = delete;
+            Backend& operator=(const Backend&) = delete;
+
+            ~Backend()
+            {
+                {
+                    std::lock_guard lock{mutex_};
+                    stop_ = true;
+                }
+                wake();
+                worker_.join();
+            }
+
+            std::shared_ptr<SpscRing> register_thread()
+            {
+                auto ring = std::make_shared<SpscRing>(ring_capacity);
+                {
+                    std::lock_guard lock{mutex_};
+                    new_rings_.push_back(ring);
+                }
+                wake(); // a sleeping thread checks only the rings it already knows
+                return ring;
+            }
+
+            void set_sink(std::ostream& sink)
+            {
+                flush();
+                std::lock_guard lock{sink_mutex_};
+                sink_ = &sink;
+            }
+
+            // producer: called after publishing into an empty ring - lock-free, a system call only if the thread sleeps
+            void notify_published() noexcept
+            {
+                if (sleeping_.load(std::memory_order_relaxed) && sleeping_.exchange(false, std::memory_order_relaxed))
+                    wake();
+            }
+
+            // blocks until everything logged before the call has been written to the sink
+            void flush()
+            {
+                std::unique_lock lock{mutex_};
+                const uint64_t ticket = ++flush_requested_;
+                wake();
+                flushed_.wait(lock, [&] { return flush_completed_ >= ticket; });
+            }
+        };
+
+        inline Backend& backend()
+        {
+            static Backend instance;
+            return instance;
+        }
+
+        inline SpscRing& thread_ring()
+        {
+            struct ThreadRing
+            {
+                std::shared_ptr<SpscRing> ring = backend().register_thread();
+
+                ~ThreadRing()
+                {
+                    ring->abandon();
+                }
+            };
+
+            thread_local ThreadRing local;
+            return *local.ring;
+        }
+    } // namespace details
+
+    // queues a formatted line "LogName: Format" - waits only if the ring of the calling thread is full;
+    // lines of one thread keep their order, lines of different threads may interleave
+    template <auto LogName, auto Format, Loggable... TArgs>
+    void write(const TArgs&... args)
+    {
+        static_assert(details::placeholder_count(Format.text) == sizeof...(TArgs), "number of arguments does not match the format string");
+
+        constexpr size_t alignment = details::record_alignment;
+        const size_t size = (sizeof(details::RecordHeader) + (details::encoded_size(args) + ... + 0) + alignment - 1) / alignment * alignment;
+
+        details::SpscRing& ring = details::thread_ring();
+        assert(size <= ring.capacity() / 2);
+
+        std::byte* record;
+        while (!(record = ring.try_reserve(size)))
+            std::this_thread::yield();
+
+        const details::RecordHeader header{size, &details::format_record<LogName, Format, details::Encoded<TArgs>...>};
+        std::memcpy(record, &header, sizeof(header));
+        std::byte* out = record + sizeof(header);
+        ((out = details::encode(out, args)), ...);
+
+        if (ring.commit(size))
+            details::backend().notify_published();
+    }
+
+    // blocks until everything logged before the call has been written
+    inline void flush()
+    {
+        details::backend().flush();
+    }
+
+    // std::cout by default - the sink must stay valid until it is replaced or the program exits
+    inline void set_sink(std::ostream& sink)
+    {
+        details::backend().set_sink(sink);
+    }
+} // namespace logging
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef INDIRECT_SORT_HPP
+#define INDIRECT_SORT_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sorting
+{
+    namespace details
+    {
+        template <typename TKey, typename TIndex>
+        struct KeyIndex
+        {
+            TKey key;
+            TIndex index;
+        };
+
+        template <typename TIndex, typename TRng, typename TCompare, typename TProj>
+        void sort_by_value(TRng& rng, TCompare& comp, TProj& proj)
+        {
+            using Key = std::remove_cvref_t<std::invoke_result_t<TProj&, decltype(*std::declval<std::ranges::range_reference_t<TRng>>())>>;
+
+            const auto first = std::ranges::begin(rng);
+            const auto size = static_cast<size_t>(std::ranges::distance(rng));
+
+            // one pass over the pointees - the sort itself runs over a contiguous array
+            std::vector<KeyIndex<Key, TIndex>> keys;
+            keys.reserve(size);
+            for (size_t i = 0; i < size; ++i)
+            {
+                const auto& ptr = first[i];
+                assert(ptr != nullptr);
+                keys.push_back({std::invoke(proj, *ptr), static_cast<TIndex>(i)});
+            }
+
+            std::ranges::sort(keys, comp, &KeyIndex<Key, TIndex>::key);
+
+            // permutation applied through a buffer - pointers are moved, not copied
+            std::vector<std::ranges::range_value_t<TRng>> sorted;
+            sorted.reserve(size);
+            for (const auto& item : keys)
+                sorted.push_back(std::ranges::iter_move(first + item.index));
+
+            std::ranges::move(sorted, first);
+        }
+    } // namespace details
+
+    // sorts a range of pointers (raw or smart) by the pointed-to values (projected with proj):
+    // every pointee is read once, so the comparisons do not chase pointers; none of the pointers may be null
+    template <std::ranges::random_access_range TRng, typename TCompare = std::ranges::less, typename TProj = std::identity>
+        requires std::ranges::sized_range<TRng> && std::permutable<std::ranges::iterator_t<TRng>>
+                 && std::movable<std::ranges::range_value_t<TRng>>
+                 && std::copyable<std::remove_cvref_t<std::invoke_result_t<TProj&, decltype(*std::declval<std::ranges::range_reference_t<TRng>>())>>>
+    void sort_by_value(TRng&& rng, TCompare comp = {}, TProj proj = {})
+    {
+        if (std::ranges::size(rng) <= std::numeric_limits<uint32_t>::max())
+            details::sort_by_value<uint32_t>(rng, comp, proj);
+        else
+            details::sort_by_value<size_t>(rng, comp, proj);
+    }
+} // namespace sorting
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef PRICING_HPP
+#define PRICING_HPP
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include <cpu_features.hpp>
+
+// batch pricing with tax rates known at compile time (Vat.value - e.g. 0.23):
+// gross = net + net * rate - multiply and add are not fused, so every path gives results identical to the scalar one
+namespace pricing
+{
+    namespace details
+    {
+        // rate in parts per million
+        consteval int64_t rate_ppm(double rate)
+        {
+            const double ppm = rate * 1'000'000;
+            return static_cast<int64_t>(ppm < 0 ? ppm - 0.5 : ppm + 0.5);
+        }
+
+        // net * ppm / 10^6 rounded half away from zero
+        constexpr int64_t tax_cents(int64_t net_cents, int64_t ppm) noexcept
+        {
+            const int64_t product = net_cents * ppm;
+            return (product < 0 ? product - 500'000 : product + 500'000) / 1'000'000;
+        }
+    } // namespace details
+
+    namespace scalar
+    {
+        template <auto Vat>
+        constexpr double gross_price(double net_price) noexcept
+        {
+            return net_price + net_price * Vat.value;
+        }
+
+        template <auto Vat>
+        void gross_prices(std::span<const double> net, std::span<double> gross) noexcept
+        {
+            for (size_t i = 0; i < net.size(); ++i)
+                gross[i] = gross_price<Vat>(net[i]);
+        }
+
+        // tax_class[i] selects the rate of item i from Vats
+        template <auto... Vats>
+        void gross_prices(std::span<const double> net, std::span<const uint8_t> tax_class, std::span<double> gross) noexcept
+        {
+            static constexpr double rates[] = {Vats.value...};
+
+            for (size_t i = 0; i < net.size(); ++i)
+            {
+                assert(tax_class[i] < sizeof...(Vats));
+                gross[i] = net[i] + net[i] * rates[tax_class[i]];
+            }
+        }
+    } // namespace scalar
+
+#ifdef CPU_HAS_SSE2
+    namespace sse2
+    {
+        template <auto Vat>
+        void gross_prices(std::span<const double> net, std::span<double> gross) noexcept
+        {
+            const __m128d rate = _mm_set1_pd(Vat.value);
+
+            size_t i = 0;
+            for (; i + 4 <= net.size(); i += 4)
+            {
+                const __m128d x0 = _mm_loadu_pd(net.data() + i);
+                const __m128d x1 = _mm_loadu_pd(net.data() + i + 2);
+                _mm_storeu_pd(gross.data() + i, _mm_add_pd(x0, _mm_mul_pd(x0, rate)));
+                _mm_storeu_pd(gross.data() + i + 2, _mm_add_pd(x1, _mm_mul_pd(x1, rate)));
+            }
+            scalar::gross_prices<Vat>(net.subspan(i), gross.subspan(i));
+        }
+
+        // no gather in SSE2 - rates are picked one by one
+        template <auto... Vats>
+        void gross_prices(std::span<const double> net, std::span<const uint8_t> tax_class, std::span<double> gross) noexcept
+        {
+            scalar::gross_prices<Vats...>(net, tax_class, gross);
+        }
+    } // namespace sse2
+#endif
+
+#ifdef CPU_HAS_AVX_DISPATCH
+    namespace avx2
+    {
+        template <auto Vat>
+        CPU_TARGET_AVX2 void gross_prices(std::span<const double> net, std::span<double> gross) noexcept
+        {
+            const __m256d rate = _mm256_set1_pd(Vat.value);
+
+            size_t i = 0;
+            for (; i + 8 <= net.size(); i += 8)
+            {
+                const __m256d x0 = _mm256_loadu_pd(net.data() + i);
+                const __m256d x1 = _mm256_loadu_pd(net.data() + i + 4);
+                _mm256_storeu_pd(gross.data() + i, _mm256_add_pd(x0, _mm256_mul_pd(x0, rate)));
+                _mm256_storeu_pd(gross.data() + i + 4, _mm256_add_pd(x1, _mm256_mul_pd(x1, rate)));
+            }
+            scalar::gross_prices<Vat>(net.subspan(i), gross.subspan(i));
+        }
+
+        template <auto... Vats>
+        CPU_TARGET_AVX2 void gross_prices(std::span<const double> net, std::span<const uint8_t> tax_class, std::span<double> gross) noexcept
+        {
+            static constexpr double rates[] = {Vats.value...};
+            const __m256d all_lanes = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+
+            size_t i = 0;
+            for (; i + 4 <= net.size(); i += 4)
+            {
+                assert(std::ranges::all_of(tax_class.subspan(i, 4), [](uint8_t c) { return c < sizeof...(Vats); }));
+
+                int32_t classes;
+                std::memcpy(&classes, tax_class.data() + i, sizeof(classes));
+                const __m128i indexes = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(classes));
+                // masked form with a zeroed source - the plain gather leaves its destination formally uninitialized
+                const __m256d rate = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), rates, indexes, all_lanes, sizeof(double));
+
+                const __m256d x = _mm256_loadu_pd(net.data() + i);
+                _mm256_storeu_pd(gross.data() + i, _mm256_add_pd(x, _mm256_mul_pd(x, rate)));
+            }
+            scalar::gross_prices<Vats...>(net.subspan(i), tax_class.subspan(i), gross.subspan(i));
+        }
+    } // namespace avx2
+#endif
+
+    // gross.size() == net.size()
+    template <auto Vat>
+    void calc_gross_prices(std::span<const double> net, std::span<double> gross) noexcept
+    {
+        assert(gross.size() == net.size());
+        CPU_DISPATCH_AVX2(gross_prices<Vat>, net, gross);
+    }
+
+    // several tax classes in one pass - item i is taxed with the rate of Vats...[tax_class[i]]
+    // (every class must be smaller than sizeof...(Vats) - checked by assert in debug builds)
+    template <auto... Vats>
+        requires(sizeof...(Vats) > 1 && sizeof...(Vats) <= 256)
+    void calc_gross_prices(std::span<const double> net, std::span<const uint8_t> tax_class, std::span<double> gross) noexcept
+    {
+        assert(gross.size() == net.size() && tax_class.size() == net.size());
+        CPU_DISPATCH_AVX2(gross_prices<Vats...>, net, tax_class, gross);
+    }
+
+    // fixed point - amounts in cents, tax rounded to the nearest cent (half away from zero);
+    // the rate is applied with a precision of 10^-6 and |net| must stay below 9.2 * 10^12 cents
+    template <auto Vat>
+    constexpr int64_t calc_gross_price_cents(int64_t net_cents) noexcept
+    {
+        constexpr int64_t ppm = details::rate_ppm(Vat.value);
+        return net_cents + details::tax_cents(net_cents, ppm);
+    }
+
+    template <auto Vat>
+    void calc_gross_prices(std::span<const int64_t> net_cents, std::span<int64_t> gross_cents) noexcept
+    {
+        assert(gross_cents.size() == net_cents.size());
+        for (size_t i = 0; i < net_cents.size(); ++i)
+            gross_cents[i] = calc_gross_price_cents<Vat>(net_cents[i]);
+    }
+
+    template <auto... Vats>
+        requires(sizeof...(Vats) > 1 && sizeof...(Vats) <= 256)
+    void calc_gross_prices(std::span<const int64_t> net_cents, std::span<const uint8_t> tax_class, std::span<int64_t> gross_cents) noexcept
+    {
+        assert(gross_cents.size() == net_cents.size() && tax_class.size() == net_cents.size());
+
+        static constexpr int64_t rates_ppm[] = {details::rate_ppm(Vats.value)...};
+        for (size_t i = 0; i < net_cents.size(); ++i)
+        {
+            assert(tax_class[i] < sizeof...(Vats));
+            gross_cents[i] = net_cents[i] + details::tax_cents(net_cents[i], rates_ppm[tax_class[i]]);
+        }
+    }
+} // namespace pricing
+
+#endif
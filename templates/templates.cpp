@@ -1,8 +1,22 @@
+#include "async_logger.hpp"
+#include "indirect_sort.hpp"
+#include "pricing.hpp"
+#include "vector_kernels.hpp"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <iostream>
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <random>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <thread>
 
 using namespace std::literals;
 
@@ -41,6 +55,79 @@ TEST_CASE("function & auto params")
     std::ranges::sort(ptrs, cmp_by_value_lambda);
 }
 
+TEST_CASE("function & auto params - sort_by_value")
+{
+    SECTION("shared_ptr")
+    {
+        std::vector ptrs = { std::make_shared<int>(42), std::make_shared<int>(1), std::make_shared<int>(665), std::make_shared<int>(7) };
+        std::vector expected = ptrs;
+        std::ranges::sort(expected, cmp_by_value_lambda);
+
+        sorting::sort_by_value(ptrs);
+        CHECK(ptrs == expected);
+
+        sorting::sort_by_value(ptrs, std::ranges::greater{});
+        CHECK(*ptrs.front() == 665);
+        CHECK(*ptrs.back() == 1);
+    }
+
+    SECTION("unique_ptr & projection")
+    {
+        std::vector<std::unique_ptr<std::string>> ptrs;
+        for (const auto& text : {"ccc"s, "a"s, "bb"s, "dddd"s})
+            ptrs.push_back(std::make_unique<std::string>(text));
+
+        sorting::sort_by_value(ptrs, std::ranges::less{}, &std::string::size);
+
+        std::vector<std::string> values;
+        for (const auto& ptr : ptrs)
+            values.push_back(*ptr);
+        CHECK(values == std::vector{"a"s, "bb"s, "ccc"s, "dddd"s});
+    }
+
+    SECTION("raw pointers")
+    {
+        std::vector<int> data(1000);
+        std::mt19937 rnd{665};
+        std::ranges::generate(data, [&] { return static_cast<int>(rnd() % 100); });
+
+        std::vector<const int*> ptrs;
+        for (const int& item : data)
+            ptrs.push_back(&item);
+
+        sorting::sort_by_value(ptrs);
+        CHECK(std::ranges::is_sorted(ptrs, cmp_by_value_lambda));
+        CHECK(std::ranges::is_permutation(ptrs, data | std::views::transform([](const int& item) { return &item; })));
+    }
+}
+
+TEST_CASE("function & auto params - sort_by_value throughput", "[.benchmark]")
+{
+    std::vector<std::shared_ptr<int>> ptrs(1'000'000);
+    std::mt19937 rnd{42};
+    std::ranges::generate(ptrs, [&] { return std::make_shared<int>(static_cast<int>(rnd())); });
+    std::ranges::shuffle(ptrs, rnd); // pointees scattered in memory relative to the order of the pointers
+
+    // every run sorts its own copy of the shuffled pointers - copies are made outside of the measured code
+    BENCHMARK_ADVANCED("std::ranges::sort(ptrs, cmp_by_value_lambda)")(Catch::Benchmark::Chronometer meter)
+    {
+        std::vector<std::vector<std::shared_ptr<int>>> runs(meter.runs(), ptrs);
+        meter.measure([&](int run) { std::ranges::sort(runs[run], cmp_by_value_lambda); });
+    };
+
+    BENCHMARK_ADVANCED("sorting::sort_by_value(ptrs)")(Catch::Benchmark::Chronometer meter)
+    {
+        std::vector<std::vector<std::shared_ptr<int>>> runs(meter.runs(), ptrs);
+        meter.measure([&](int run) { sorting::sort_by_value(runs[run]); });
+    };
+
+    auto sorted_directly = ptrs;
+    std::ranges::sort(sorted_directly, cmp_by_value_lambda);
+    auto sorted_indirectly = ptrs;
+    sorting::sort_by_value(sorted_indirectly);
+
+    CHECK(std::ranges::equal(sorted_directly, sorted_indirectly, {}, [](const auto& ptr) { return *ptr; }, [](const auto& ptr) { return *ptr; }));
+}
 
 template <double Factor, typename T>
 auto scale(T x)
@@ -53,6 +140,56 @@ TEST_CASE("NTTP & floating points")
     CHECK(scale<2.0>(8) == 16.0);
 }
 
+TEST_CASE("NTTP & floating points - vector kernels")
+{
+    static_assert(kernels::Poly<1.0, 2.0, 3.0>::apply(2.0) == 17.0);
+    static_assert(kernels::Clamp<-1.0, 1.0>::apply(5.0) == 1.0);
+
+    std::mt19937_64 rnd{665};
+    std::uniform_real_distribution<double> value{-10.0, 10.0};
+
+    std::vector<double> in(67);
+    std::ranges::generate(in, [&] { return value(rnd); });
+    in[3] = std::numeric_limits<double>::quiet_NaN();
+    in[10] = std::numeric_limits<double>::infinity();
+    in[11] = -0.0;
+    in[66] = -std::numeric_limits<double>::infinity();
+
+    auto check_kernel = [&]<typename TOperation>(void (*kernel)(std::span<const double>, std::span<double>)) {
+        for (size_t size : {0, 1, 7, 8, 9, 15, 16, 17, 67})
+        {
+            const std::span<const double> input = std::span{in}.first(size);
+            std::vector<double> out(size), expected(size);
+
+            kernel(input, out);
+            kernels::scalar::transform<TOperation>(input, expected);
+            CHECK(std::ranges::equal(std::as_bytes(std::span{out}), std::as_bytes(std::span{expected}))); // bit-identical, NaN included
+        }
+    };
+
+    // the dispatched kernel and every ISA-specific one supported by the CPU
+    auto check_kernels = [&]<typename TOperation>(void (*kernel)(std::span<const double>, std::span<double>)) {
+        check_kernel.template operator()<TOperation>(kernel);
+#ifdef CPU_HAS_AVX_DISPATCH
+        if (helpers::cpu::has_avx2)
+            check_kernel.template operator()<TOperation>(kernels::avx2::transform<TOperation>);
+        if (helpers::cpu::has_avx512)
+            check_kernel.template operator()<TOperation>(kernels::avx512::transform<TOperation>);
+#endif
+    };
+
+    check_kernels.operator()<kernels::Scale<2.5>>(kernels::scale<2.5>);
+    check_kernels.operator()<kernels::Affine<0.5, -3.0>>(kernels::affine<0.5, -3.0>);
+    check_kernels.operator()<kernels::Clamp<-1.0, 1.0>>(kernels::clamp<-1.0, 1.0>);
+    check_kernels.operator()<kernels::Poly<1.0, -0.5, 0.25, 0.125>>(kernels::poly<1.0, -0.5, 0.25, 0.125>);
+
+    std::vector<double> data = {-2.0, 0.5, 3.0};
+    kernels::clamp<-1.0, 1.0>(data, data); // in place
+    CHECK(data == std::vector{-1.0, 0.5, 1.0});
+    kernels::affine<2.0, 1.0>(data, data);
+    CHECK(data == std::vector{-1.0, 2.0, 3.0});
+}
+
 struct Tax
 {
     double value;
@@ -76,6 +213,124 @@ TEST_CASE("NTTP & structs")
     REQUIRE(calc_gross_price<vat_ger>(100.0) == 119.0);
 }
 
+TEST_CASE("NTTP & structs - batch pricing")
+{
+    constexpr Tax vat_pl{0.23};
+    constexpr Tax vat_ger{0.19};
+    constexpr Tax vat_food{0.05};
+
+    std::mt19937_64 rnd{665};
+    std::uniform_real_distribution<double> price{-100.0, 10'000.0};
+
+    auto same_bits = [](const std::vector<double>& a, const std::vector<double>& b) {
+        return std::ranges::equal(std::as_bytes(std::span{a}), std::as_bytes(std::span{b})); // not memcmp - data() of an empty vector may be nullptr
+    };
+
+    for (size_t size : {0, 1, 3, 4, 7, 8, 9, 31, 1000})
+    {
+        std::vector<double> net(size);
+        std::vector<uint8_t> tax_class(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            net[i] = price(rnd);
+            tax_class[i] = static_cast<uint8_t>(rnd() % 3);
+        }
+
+        std::vector<double> gross(size), expected(size);
+
+        pricing::calc_gross_prices<vat_pl>(net, gross);
+        std::ranges::transform(net, expected.begin(), calc_gross_price<vat_pl>);
+        CHECK(same_bits(gross, expected));
+
+        pricing::calc_gross_prices<vat_pl, vat_ger, vat_food>(net, tax_class, gross);
+        for (size_t i = 0; i < size; ++i)
+        {
+            const double prices[] = {calc_gross_price<vat_pl>(net[i]), calc_gross_price<vat_ger>(net[i]), calc_gross_price<vat_food>(net[i])};
+            expected[i] = prices[tax_class[i]];
+        }
+        CHECK(same_bits(gross, expected));
+    }
+
+    SECTION("cents")
+    {
+        static_assert(pricing::calc_gross_price_cents<vat_pl>(10'000) == 12'300);
+        static_assert(pricing::calc_gross_price_cents<vat_pl>(5) == 6);   // tax 1.15 cents
+        static_assert(pricing::calc_gross_price_cents<vat_pl>(50) == 62); // tax 11.5 cents
+        static_assert(pricing::calc_gross_price_cents<vat_pl>(-50) == -62);
+
+        const std::vector<int64_t> net = {100, 999, 12'345, -50};
+        const std::vector<uint8_t> tax_class = {0, 1, 2, 0};
+        std::vector<int64_t> gross(net.size());
+
+        pricing::calc_gross_prices<vat_ger>(net, gross);
+        CHECK(gross == std::vector<int64_t>{119, 1'189, 14'691, -60});
+
+        pricing::calc_gross_prices<vat_pl, vat_ger, vat_food>(net, tax_class, gross);
+        CHECK(gross == std::vector<int64_t>{123, 1'189, 12'962, -62});
+    }
+}
+
+TEST_CASE("NTTP & structs - batch pricing throughput", "[.benchmark]")
+{
+    constexpr Tax vat_pl{0.23};
+    constexpr Tax vat_ger{0.19};
+
+    std::mt19937_64 rnd{42};
+    std::uniform_real_distribution<double> price{0.0, 10'000.0};
+
+    std::vector<double> net(10'000'000);
+    std::ranges::generate(net, [&] { return price(rnd); });
+    std::vector<uint8_t> tax_class(net.size());
+    std::ranges::generate(tax_class, [&] { return static_cast<uint8_t>(rnd() % 2); });
+    std::vector<int64_t> net_cents(net.size());
+    std::ranges::transform(net, net_cents.begin(), [](double x) { return static_cast<int64_t>(x * 100); });
+
+    std::vector<double> gross(net.size());
+    std::vector<int64_t> gross_cents(net.size());
+
+    BENCHMARK("scalar loop")
+    {
+        for (size_t i = 0; i < net.size(); ++i)
+            gross[i] = calc_gross_price<vat_pl>(net[i]);
+        return gross.back();
+    };
+
+    BENCHMARK("calc_gross_prices")
+    {
+        pricing::calc_gross_prices<vat_pl>(net, gross);
+        return gross.back();
+    };
+
+    BENCHMARK("calc_gross_prices - 2 tax classes")
+    {
+        pricing::calc_gross_prices<vat_pl, vat_ger>(net, tax_class, gross);
+        return gross.back();
+    };
+
+    BENCHMARK("calc_gross_prices - cents")
+    {
+        pricing::calc_gross_prices<vat_pl>(net_cents, gross_cents);
+        return gross_cents.back();
+    };
+
+    // batch resident in L1 - 10M items are bound by memory bandwidth
+    const std::span<const double> batch = std::span{net}.first(2048);
+    const std::span<double> batch_gross = std::span{gross}.first(2048);
+
+    BENCHMARK("scalar loop - 2048 items")
+    {
+        for (size_t i = 0; i < batch.size(); ++i)
+            batch_gross[i] = calc_gross_price<vat_pl>(batch[i]);
+        return batch_gross.back();
+    };
+
+    BENCHMARK("calc_gross_prices - 2048 items")
+    {
+        pricing::calc_gross_prices<vat_pl>(batch, batch_gross);
+        return batch_gross.back();
+    };
+}
+
 template <size_t N>
 struct Str
 {
@@ -94,13 +349,71 @@ struct Str
     }
 };
 
+// compile-time configuration of the loggers - the longest matching pattern wins
+constexpr logging::LogRule log_rules[] = {
+    {"*", logging::Level::debug},
+    {"net.", logging::Level::warning},
+    {"net.audit", logging::Level::info},
+    {"quiet_logger", logging::Level::off}};
+
+// lines are written asynchronously by the background thread of the logging library;
+// statements below the level configured for LogName in log_rules compile to nothing
+// (their arguments are still evaluated)
 template <Str LogName>
 class Logger
 {
+    template <logging::Level Level, Str Format, typename... TArgs>
+    static void write(const TArgs&... args)
+    {
+        if constexpr (is_compiled_in(Level))
+        {
+            if (logging::is_enabled(Level))
+                logging::write<LogName, Format>(args...);
+        }
+    }
+
 public:
+    static constexpr logging::Level min_level = logging::min_level(LogName.text, log_rules);
+
+    static constexpr bool is_compiled_in(logging::Level level)
+    {
+        return level != logging::Level::off && level >= min_level;
+    }
+
     void log(std::string_view msg)
     {
-        std::cout << LogName << ": " << msg << "\n";
+        write<logging::Level::info, "{}">(msg);
+    }
+
+    // format parsed at compile time - "{}" is replaced with the next argument
+    template <Str Format, logging::Loggable... TArgs>
+    void log(const TArgs&... args)
+    {
+        write<logging::Level::info, Format>(args...);
+    }
+
+    template <Str Format, logging::Loggable... TArgs>
+    void trace(const TArgs&... args)
+    {
+        write<logging::Level::trace, Format>(args...);
+    }
+
+    template <Str Format, logging::Loggable... TArgs>
+    void debug(const TArgs&... args)
+    {
+        write<logging::Level::debug, Format>(args...);
+    }
+
+    template <Str Format, logging::Loggable... TArgs>
+    void warning(const TArgs&... args)
+    {
+        write<logging::Level::warning, Format>(args...);
+    }
+
+    template <Str Format, logging::Loggable... TArgs>
+    void error(const TArgs&... args)
+    {
+        write<logging::Level::error, Format>(args...);
     }
 };
 
@@ -113,6 +426,151 @@ TEST_CASE("NTTP & strings")
     logger_2.log("Stop");
 }
 
+// redirects the log for the scope of a test - the default sink and level are restored even if a check fails
+class ScopedLogSink
+{
+public:
+    explicit ScopedLogSink(std::ostream& sink)
+    {
+        logging::set_sink(sink);
+    }
+
+    ScopedLogSink(const ScopedLogSink&) = delete;
+    ScopedLogSink& operator=(const ScopedLogSink&) = delete;
+
+    ~ScopedLogSink()
+    {
+        logging::set_level(logging::Level::trace);
+        logging::set_sink(std::cout);
+    }
+};
+
+TEST_CASE("NTTP & strings - async logger")
+{
+    static_assert(logging::details::placeholder_count("{} of {{}} {}") == 2);
+
+    std::ostringstream out;
+    ScopedLogSink sink_guard{out};
+
+    Logger<"main_logger"> logger;
+
+    SECTION("formatting")
+    {
+        logger.log("Start");
+        logger.log<"{} + {} = {} ({})">(2, 0.5, 2.5, true);
+        logger.log<"{{{}}} - {}">('x', "text"s);
+        logging::flush();
+
+        CHECK(out.str() == "main_logger: Start\nmain_logger: 2 + 0.5 = 2.5 (true)\nmain_logger: {x} - text\n");
+    }
+
+    SECTION("many threads")
+    {
+        constexpr int thread_count = 4;
+        constexpr int line_count = 20'000; // wraps around the ring of every thread
+
+        {
+            std::vector<std::jthread> threads;
+            for (int t = 0; t < thread_count; ++t)
+                threads.emplace_back([t] {
+                    Logger<"worker"> worker_logger;
+                    for (int i = 0; i < line_count; ++i)
+                        worker_logger.log<"{} {}">(t, i);
+                });
+        }
+        logging::flush();
+
+        std::vector<int> next_line(thread_count, 0);
+        std::istringstream lines{out.str()};
+        std::string name;
+        int t, i;
+        while (lines >> name >> t >> i)
+        {
+            REQUIRE(name == "worker:");
+            REQUIRE(i == next_line[t]++); // lines of every thread in order
+        }
+        CHECK(next_line == std::vector<int>(thread_count, line_count));
+    }
+}
+
+TEST_CASE("NTTP & strings - async logger latency", "[.benchmark]")
+{
+    std::ostringstream out;
+    ScopedLogSink sink_guard{out};
+
+    Logger<"main_logger"> logger;
+
+    BENCHMARK("log - busy backend")
+    {
+        logger.log<"{} + {}">(1, 2.5);
+    };
+
+    // single calls after a pause - the background thread has drained the ring, the call must not take a lock;
+    // after a pause shorter than the polling time the thread is still awake and the call makes no system call
+    const auto pause_latency = [&](std::chrono::microseconds pause) {
+        std::vector<std::chrono::nanoseconds> latencies;
+        for (int i = 0; i < 1'000; ++i)
+        {
+            std::this_thread::sleep_for(pause);
+            const auto start = std::chrono::steady_clock::now();
+            logger.log<"{} + {}">(i, 2.5);
+            latencies.push_back(std::chrono::steady_clock::now() - start);
+        }
+        logging::flush();
+
+        std::ranges::sort(latencies);
+        std::cout << "log after " << pause << " pause - median: " << latencies[latencies.size() / 2]
+                  << ", p99: " << latencies[latencies.size() * 99 / 100] << ", max: " << latencies.back() << "\n";
+        return latencies[latencies.size() / 2];
+    };
+
+    CHECK(pause_latency(logging::details::Backend::idle_poll_time / 4) < 1us);
+    pause_latency(1ms); // the thread sleeps - the call wakes it up
+}
+
+TEST_CASE("NTTP & strings - log levels")
+{
+    static_assert(Logger<"main_logger">::min_level == logging::Level::debug);
+    static_assert(Logger<"net.tcp">::min_level == logging::Level::warning);
+    static_assert(Logger<"net.audit">::min_level == logging::Level::info);
+    static_assert(Logger<"network">::min_level == logging::Level::debug);
+    static_assert(!Logger<"main_logger">::is_compiled_in(logging::Level::trace));
+    static_assert(!Logger<"quiet_logger">::is_compiled_in(logging::Level::error));
+
+    std::ostringstream out;
+    ScopedLogSink sink_guard{out};
+
+    Logger<"main_logger"> logger;
+    Logger<"net.tcp"> tcp_logger;
+    Logger<"quiet_logger"> quiet_logger;
+
+    SECTION("compile-time filters")
+    {
+        logger.trace<"hidden {}">(1);
+        logger.debug<"shown {}">(2);
+        tcp_logger.log("hidden");
+        tcp_logger.warning<"shown {}">(3);
+        quiet_logger.error<"hidden {}">(4);
+        logging::flush();
+
+        CHECK(out.str() == "main_logger: shown 2\nnet.tcp: shown 3\n");
+    }
+
+    SECTION("runtime level")
+    {
+        logging::set_level(logging::Level::error);
+        logger.log("hidden");
+        tcp_logger.warning<"hidden {}">(1);
+        tcp_logger.error<"shown {}">(2);
+
+        logging::set_level(logging::Level::trace);
+        logger.debug<"shown {}">(3);
+        logging::flush();
+
+        CHECK(out.str() == "net.tcp: shown 2\nmain_logger: shown 3\n");
+    }
+}
+
 template <std::invocable auto GetVat>
 double calculate_gross_price_with_lambda(double price)
 {
@@ -0,0 +1,210 @@
+#ifndef VECTOR_KERNELS_HPP
+#define VECTOR_KERNELS_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <cpu_features.hpp>
+
+#ifdef CPU_HAS_AVX_DISPATCH
+// AVX-512F implies FMA - contraction of multiplies and adds is turned off for the avx512 paths
+#define KERNELS_TARGET_AVX512 CPU_TARGET_AVX512 __attribute__((optimize("fp-contract=off")))
+#endif
+
+// element-wise kernels over spans of doubles with constants passed as template parameters - the constants are
+// broadcast once per call and every operation is a plain IEEE multiply, add, min or max (never fused),
+// so all code paths give results identical to the scalar one
+namespace kernels
+{
+    // operations - apply() for a scalar and for every vector width
+
+    template <double Factor>
+    struct Scale
+    {
+        static constexpr double apply(double x) noexcept
+        {
+            return x * Factor;
+        }
+
+#ifdef CPU_HAS_AVX_DISPATCH
+        CPU_TARGET_AVX2 static __m256d apply(__m256d x) noexcept
+        {
+            return _mm256_mul_pd(x, _mm256_set1_pd(Factor));
+        }
+
+        KERNELS_TARGET_AVX512 static __m512d apply(__m512d x) noexcept
+        {
+            return _mm512_mul_pd(x, _mm512_set1_pd(Factor));
+        }
+#endif
+    };
+
+    template <double A, double B>
+    struct Affine
+    {
+        static constexpr double apply(double x) noexcept
+        {
+            return x * A + B;
+        }
+
+#ifdef CPU_HAS_AVX_DISPATCH
+        CPU_TARGET_AVX2 static __m256d apply(__m256d x) noexcept
+        {
+            return _mm256_add_pd(_mm256_mul_pd(x, _mm256_set1_pd(A)), _mm256_set1_pd(B));
+        }
+
+        KERNELS_TARGET_AVX512 static __m512d apply(__m512d x) noexcept
+        {
+            return _mm512_add_pd(_mm512_mul_pd(x, _mm512_set1_pd(A)), _mm512_set1_pd(B));
+        }
+#endif
+    };
+
+    // std::clamp semantics - NaN stays NaN
+    template <double Low, double High>
+        requires(Low <= High)
+    struct Clamp
+    {
+        static constexpr double apply(double x) noexcept
+        {
+            return (x < Low) ? Low : (High < x) ? High : x;
+        }
+
+#ifdef CPU_HAS_AVX_DISPATCH
+        // max(a, b) returns b unless a > b - the operand order keeps NaN of x
+        CPU_TARGET_AVX2 static __m256d apply(__m256d x) noexcept
+        {
+            return _mm256_min_pd(_mm256_set1_pd(High), _mm256_max_pd(_mm256_set1_pd(Low), x));
+        }
+
+        // zero-masked forms with all lanes selected - the plain ones start from an undefined vector
+        // and trigger -Wmaybe-uninitialized in GCC 12
+        KERNELS_TARGET_AVX512 static __m512d apply(__m512d x) noexcept
+        {
+            constexpr __mmask8 all_lanes = 0xFF;
+            return _mm512_maskz_min_pd(all_lanes, _mm512_set1_pd(High), _mm512_maskz_max_pd(all_lanes, _mm512_set1_pd(Low), x));
+        }
+#endif
+    };
+
+    // Coeffs[0] + Coeffs[1] * x + Coeffs[2] * x^2 + ... evaluated with the Horner scheme
+    template <double... Coeffs>
+        requires(sizeof...(Coeffs) > 0)
+    struct Poly
+    {
+        static constexpr double coeffs[] = {Coeffs...};
+        static constexpr size_t degree = sizeof...(Coeffs) - 1;
+
+        static constexpr double apply(double x) noexcept
+        {
+            double result = coeffs[degree];
+            for (size_t i = degree; i-- > 0;)
+                result = result * x + coeffs[i];
+            return result;
+        }
+
+#ifdef CPU_HAS_AVX_DISPATCH
+        CPU_TARGET_AVX2 static __m256d apply(__m256d x) noexcept
+        {
+            __m256d result = _mm256_set1_pd(coeffs[degree]);
+            for (size_t i = degree; i-- > 0;) // unrolled - the trip count is a constant
+                result = _mm256_add_pd(_mm256_mul_pd(result, x), _mm256_set1_pd(coeffs[i]));
+            return result;
+        }
+
+        KERNELS_TARGET_AVX512 static __m512d apply(__m512d x) noexcept
+        {
+            __m512d result = _mm512_set1_pd(coeffs[degree]);
+            for (size_t i = degree; i-- > 0;)
+                result = _mm512_add_pd(_mm512_mul_pd(result, x), _mm512_set1_pd(coeffs[i]));
+            return result;
+        }
+#endif
+    };
+
+    namespace scalar
+    {
+        template <typename TOperation>
+        constexpr void transform(std::span<const double> in, std::span<double> out) noexcept
+        {
+            for (size_t i = 0; i < in.size(); ++i)
+                out[i] = TOperation::apply(in[i]);
+        }
+    } // namespace scalar
+
+#ifdef CPU_HAS_AVX_DISPATCH
+    namespace avx2
+    {
+        template <typename TOperation>
+        CPU_TARGET_AVX2 void transform(std::span<const double> in, std::span<double> out) noexcept
+        {
+            size_t i = 0;
+            for (; i + 8 <= in.size(); i += 8)
+            {
+                const __m256d x0 = _mm256_loadu_pd(in.data() + i);
+                const __m256d x1 = _mm256_loadu_pd(in.data() + i + 4);
+                _mm256_storeu_pd(out.data() + i, TOperation::apply(x0));
+                _mm256_storeu_pd(out.data() + i + 4, TOperation::apply(x1));
+            }
+            for (; i < in.size(); ++i)
+                out[i] = TOperation::apply(in[i]);
+        }
+    } // namespace avx2
+
+    namespace avx512
+    {
+        // the tail is processed with masked loads and stores
+        template <typename TOperation>
+        KERNELS_TARGET_AVX512 void transform(std::span<const double> in, std::span<double> out) noexcept
+        {
+            size_t i = 0;
+            for (; i + 8 <= in.size(); i += 8)
+                _mm512_storeu_pd(out.data() + i, TOperation::apply(_mm512_loadu_pd(in.data() + i)));
+
+            if (i < in.size())
+            {
+                const auto mask = static_cast<__mmask8>((1u << (in.size() - i)) - 1);
+                _mm512_mask_storeu_pd(out.data() + i, mask, TOperation::apply(_mm512_maskz_loadu_pd(mask, in.data() + i)));
+            }
+        }
+    } // namespace avx512
+#endif
+
+    // out[i] = TOperation::apply(in[i]) - out.size() == in.size(), out may be the same span as in
+    template <typename TOperation>
+    void transform(std::span<const double> in, std::span<double> out) noexcept
+    {
+        assert(out.size() == in.size());
+        CPU_DISPATCH_AVX512(transform<TOperation>, in, out);
+    }
+
+    template <double Factor>
+    void scale(std::span<const double> in, std::span<double> out) noexcept
+    {
+        transform<Scale<Factor>>(in, out);
+    }
+
+    template <double A, double B>
+    void affine(std::span<const double> in, std::span<double> out) noexcept
+    {
+        transform<Affine<A, B>>(in, out);
+    }
+
+    template <double Low, double High>
+    void clamp(std::span<const double> in, std::span<double> out) noexcept
+    {
+        transform<Clamp<Low, High>>(in, out);
+    }
+
+    template <double... Coeffs>
+    void poly(std::span<const double> in, std::span<double> out) noexcept
+    {
+        transform<Poly<Coeffs...>>(in, out);
+    }
+} // namespace kernels
+
+#undef KERNELS_TARGET_AVX512
+
+#endif